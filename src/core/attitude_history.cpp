@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "attitude_history.h"
+
+namespace {
+/**
+ * @brief Lookup retries when the writer overwrites the searched samples
+ */
+const int MaxLookupAttempts = 4;
+}
+
+AttitudeHistory::AttitudeHistory() :
+    m_count(0)
+{
+    for (Slot &slot : m_slots) {
+        slot.lock.store(0, std::memory_order_relaxed);
+    }
+}
+
+void AttitudeHistory::append(const AttitudeSample &sample)
+{
+    append(sample, Quaternion::fromEuler(sample.roll, sample.pitch, sample.yaw));
+}
+
+void AttitudeHistory::append(const AttitudeSample &sample, const Quaternion &q)
+{
+    const quint64 seq = m_count.load(std::memory_order_relaxed) + 1;
+    Slot &slot = m_slots[seq & (Capacity - 1)];
+
+    const quint32 lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.entry.seq = seq;
+    slot.entry.sample = sample;
+    slot.entry.q = q;
+    slot.lock.store(lock + 2, std::memory_order_release);
+
+    m_count.store(seq, std::memory_order_release);
+}
+
+bool AttitudeHistory::read(quint64 seq, Entry *entry) const
+{
+    const Slot &slot = m_slots[seq & (Capacity - 1)];
+    for (;;) {
+        const quint32 lock = slot.lock.load(std::memory_order_acquire);
+        if (lock & 1) {
+            continue;
+        }
+        *entry = slot.entry;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.lock.load(std::memory_order_relaxed) == lock) {
+            break;
+        }
+    }
+    return entry->seq == seq;
+}
+
+bool AttitudeHistory::latest(AttitudeSample *sample, Quaternion *q, quint64 *seq) const
+{
+    for (int attempt = 0; attempt < MaxLookupAttempts; ++attempt) {
+        const quint64 count = this->count();
+        if (count == 0) {
+            return false;
+        }
+        Entry entry;
+        if (read(count, &entry)) {
+            *sample = entry.sample;
+            if (q) {
+                *q = entry.q;
+            }
+            if (seq) {
+                *seq = entry.seq;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AttitudeHistory::at(qint64 timeNs, AttitudeSample *sample, Quaternion *q, quint64 *seq) const
+{
+    for (int attempt = 0; attempt < MaxLookupAttempts; ++attempt) {
+        const quint64 count = this->count();
+        if (count == 0) {
+            return false;
+        }
+        // The oldest slot is the next one to be overwritten, skip it
+        quint64 low = count > Capacity - 1 ? count - Capacity + 2 : 1;
+        quint64 high = count;
+        Entry before;
+        Entry after;
+        if (!read(high, &after)) {
+            continue;
+        }
+        if (timeNs >= after.sample.rxTimeNs) {
+            if (timeNs > after.sample.rxTimeNs) {
+                return false;
+            }
+            before = after;
+            low = high;
+        } else {
+            if (!read(low, &before)) {
+                continue;
+            }
+            if (timeNs < before.sample.rxTimeNs) {
+                return false;
+            }
+        }
+
+        // Keep before.rxTimeNs <= timeNs < after.rxTimeNs
+        bool overwritten = false;
+        while (high - low > 1) {
+            const quint64 middle = low + (high - low) / 2;
+            Entry entry;
+            if (!read(middle, &entry)) {
+                overwritten = true;
+                break;
+            }
+            if (entry.sample.rxTimeNs <= timeNs) {
+                low = middle;
+                before = entry;
+            } else {
+                high = middle;
+                after = entry;
+            }
+        }
+        if (overwritten) {
+            continue;
+        }
+
+        if (low == high || before.sample.rxTimeNs == timeNs) {
+            *sample = before.sample;
+            if (q) {
+                *q = before.q;
+            }
+            if (seq) {
+                *seq = before.seq;
+            }
+            return true;
+        }
+
+        const AttitudeSample &a = before.sample;
+        const AttitudeSample &b = after.sample;
+        const float fraction = static_cast<float>(
+                    static_cast<double>(timeNs - a.rxTimeNs) / (b.rxTimeNs - a.rxTimeNs));
+        const Quaternion interpolated = Quaternion::slerp(before.q, after.q, fraction);
+
+        sample->timeBootMs = a.timeBootMs + static_cast<qint32>(
+                    fraction * static_cast<qint32>(b.timeBootMs - a.timeBootMs) + 0.5f);
+        sample->rxTimeNs = timeNs;
+        interpolated.toEuler(&sample->roll, &sample->pitch, &sample->yaw);
+        sample->rollspeed = a.rollspeed + fraction * (b.rollspeed - a.rollspeed);
+        sample->pitchspeed = a.pitchspeed + fraction * (b.pitchspeed - a.pitchspeed);
+        sample->yawspeed = a.yawspeed + fraction * (b.yawspeed - a.yawspeed);
+        if (q) {
+            *q = interpolated;
+        }
+        if (seq) {
+            *seq = fraction < 0.5f ? before.seq : after.seq;
+        }
+        return true;
+    }
+    return false;
+}
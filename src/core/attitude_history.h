@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_history.h
+ * @brief File contains a declaration of the time-indexed attitude history - AttitudeHistory
+ */
+
+#ifndef ATTITUDE_HISTORY_H
+#define ATTITUDE_HISTORY_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+#include "attitude_sample.h"
+#include "quaternion.h"
+
+/**
+ * @brief Ring of recent attitude samples looked up by time
+ *
+ * One thread appends samples while any number of threads look them up
+ * without locking: every slot is guarded by a seqlock, a reader copies the
+ * slot and retries if the writer touched it meanwhile. The writer never
+ * waits for readers.
+ *
+ * Samples are kept in a fixed array in receive order, so a lookup by host
+ * receive time is a binary search. Between two samples the attitude is
+ * interpolated with SLERP of their quaternions.
+ */
+class AttitudeHistory
+{
+public:
+    /**
+     * @brief Number of samples kept, a power of two
+     */
+    static const int Capacity = 1024;
+
+    AttitudeHistory();
+
+    /**
+     * @brief Append a sample (writer side)
+     *
+     * Samples must be appended in the order of their receive time.
+     *
+     * @param sample attitude sample
+     */
+    void append(const AttitudeSample &sample);
+    /**
+     * @brief Append a sample with its quaternion known (writer side)
+     * @param sample attitude sample
+     * @param q attitude quaternion of the sample
+     * @see append(const AttitudeSample &)
+     */
+    void append(const AttitudeSample &sample, const Quaternion &q);
+
+    /**
+     * @brief Get the number of samples appended so far
+     *
+     * The n-th appended sample has the sequence number n, starting from 1.
+     *
+     * @return Number of samples
+     */
+    quint64 count() const { return m_count.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the newest sample
+     * @param sample newest sample
+     * @param q attitude quaternion of the sample, may be Q_NULLPTR
+     * @param seq sequence number of the sample, may be Q_NULLPTR
+     * @return false if there are no samples
+     */
+    bool latest(AttitudeSample *sample, Quaternion *q = Q_NULLPTR,
+                quint64 *seq = Q_NULLPTR) const;
+
+    /**
+     * @brief Get the attitude at a host time
+     *
+     * Angles are interpolated with SLERP, angular speeds and the autopilot
+     * time linearly.
+     *
+     * @param timeNs host monotonic time (ns)
+     * @param sample attitude at @p timeNs
+     * @param q attitude quaternion at @p timeNs, may be Q_NULLPTR
+     * @param seq sequence number of the nearest sample, may be Q_NULLPTR
+     * @return false if the time is outside the kept samples
+     */
+    bool at(qint64 timeNs, AttitudeSample *sample, Quaternion *q = Q_NULLPTR,
+            quint64 *seq = Q_NULLPTR) const;
+
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "AttitudeHistory capacity must be a power of two");
+
+    /**
+     * @brief Stored sample
+     */
+    struct Entry
+    {
+        /**
+         * @brief Sequence number of the sample, 0 if the slot is unused
+         */
+        quint64 seq = 0;
+        AttitudeSample sample;
+        Quaternion q;
+    };
+
+    /**
+     * @brief Ring slot
+     */
+    struct Slot
+    {
+        /**
+         * @brief Seqlock counter, odd while the slot is being written
+         */
+        std::atomic<quint32> lock;
+        Entry entry;
+    };
+
+    /**
+     * @brief Copy the entry of a sample
+     * @param seq sequence number of the sample
+     * @param entry copied entry
+     * @return false if the sample was already overwritten
+     */
+    bool read(quint64 seq, Entry *entry) const;
+
+private:
+    /**
+     * @brief Samples, the one with sequence number n is in slot n % Capacity
+     */
+    Slot m_slots[Capacity];
+    /**
+     * @brief Number of samples appended so far
+     */
+    std::atomic<quint64> m_count;
+};
+
+#endif // #ifndef ATTITUDE_HISTORY_H
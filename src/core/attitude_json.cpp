@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "attitude_json.h"
+#include "monotonic_clock.h"
+
+using FastFormat::appendLiteral;
+
+char *AttitudeJson::append(char *out, const AttitudeSample &sample, quint64 seq)
+{
+    const qint64 timeUs = (sample.rxTimeNs + MonotonicClock::systemOffset()) / 1000;
+
+    out = appendLiteral(out, "{\"seq\":");
+    out = FastFormat::appendInt(out, static_cast<qint64>(seq));
+    out = appendLiteral(out, ",\"t\":");
+    out = FastFormat::appendInt(out, timeUs);
+    out = appendLiteral(out, ",\"tb\":");
+    out = FastFormat::appendInt(out, sample.timeBootMs);
+    if (sample.timeNs != 0) {
+        out = appendLiteral(out, ",\"tm\":");
+        out = FastFormat::appendInt(out, (sample.timeNs + MonotonicClock::systemOffset()) / 1000);
+    }
+    out = appendLiteral(out, ",\"r\":");
+    out = FastFormat::appendFixed(out, sample.roll);
+    out = appendLiteral(out, ",\"p\":");
+    out = FastFormat::appendFixed(out, sample.pitch);
+    out = appendLiteral(out, ",\"y\":");
+    out = FastFormat::appendFixed(out, sample.yaw);
+    if (sample.predictionNs != 0) {
+        out = appendLiteral(out, ",\"dt\":");
+        out = FastFormat::appendInt(out, sample.predictionNs / 1000);
+    }
+    *out++ = '}';
+    return out;
+}
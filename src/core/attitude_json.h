@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_json.h
+ * @brief File contains the compact JSON representation of attitude samples
+ */
+
+#ifndef ATTITUDE_JSON_H
+#define ATTITUDE_JSON_H
+
+#include "attitude_sample.h"
+#include "fast_format.h"
+
+/**
+ * @brief Compact JSON representation of attitude samples
+ *
+ * A sample is written as
+ * {"seq":12,"t":1508236800123456,"tb":123456,"r":0.01,"p":-0.02,"y":1.57}
+ * where "seq" is the sample sequence number, "t" the host receive time (us
+ * since the epoch), "tb" the autopilot time since boot (ms) and "r", "p",
+ * "y" the angles (rad). With the autopilot clock synchronised, "tm" is the
+ * host time the autopilot measured the sample (us since the epoch). Angles
+ * projected forward to compensate latency are followed by "dt", the
+ * projection time (us).
+ */
+namespace AttitudeJson {
+
+/**
+ * @brief Maximal number of characters written by append()
+ */
+const int MaxLength = 52 + 5 * FastFormat::MaxIntLength + 3 * FastFormat::MaxFixedLength;
+
+/**
+ * @brief Write a sample as a JSON object
+ * @param out buffer with room for MaxLength characters
+ * @param sample attitude sample
+ * @param seq sample sequence number
+ * @return Pointer past the last written character
+ */
+char *append(char *out, const AttitudeSample &sample, quint64 seq);
+
+} // namespace AttitudeJson
+
+#endif // #ifndef ATTITUDE_JSON_H
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+
+#include "attitude_kernels.h"
+
+#include <math.h>
+
+namespace {
+const float Pi = 3.14159265358979f;
+const float HalfPi = 1.57079632679490f;
+const float QuarterPi = 0.785398163397448f;
+const float TwoOverPi = 0.636619772367581f;
+/**
+ * @brief tan(pi/8), atan() arguments above it are reduced around pi/4
+ */
+const float TanEighthPi = 0.414213562373095f;
+/**
+ * @brief pi/2 split for the exact sin/cos argument reduction (Cody-Waite)
+ */
+const float HalfPi1 = 1.5703125f;
+const float HalfPi2 = 4.837512969970703125e-4f;
+const float HalfPi3 = 7.54978995489188216e-8f;
+/**
+ * @brief Largest sin/cos argument in quarter turns, larger ones give garbage
+ */
+const float MaxQuadrant = 1.0e6f;
+/**
+ * @brief Distance of pitch from pi/2 treated as the gimbal lock
+ */
+const float GimbalLockMargin = 1.0e-3f;
+
+// The helpers are inlined into the loops. They must not branch or call
+// library functions other than fabsf, copysignf and sqrtf, which compile to
+// instructions, so the loops stay vectorisable. Polynomial coefficients are
+// from the Cephes single precision library.
+
+/**
+ * @brief Arc tangent of a value in [0, 1]
+ */
+inline float atanUnit(float t)
+{
+    // Both candidates are computed, a conditional division isn't vectorised
+    const float shifted = (t - 1) / (t + 1);
+    const bool reduced = t > TanEighthPi;
+    const float u = reduced ? shifted : t;
+    const float z = u * u;
+    const float a = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z
+                      + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * u + u;
+    return reduced ? a + QuarterPi : a;
+}
+
+/**
+ * @brief Arc tangent of y/x in [-pi, pi]
+ */
+inline float atan2Fast(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float high = ax > ay ? ax : ay;
+    const float low = ax > ay ? ay : ax;
+    const float ratio = low / (high > 0 ? high : 1);
+    float a = atanUnit(ratio);
+    a = ay > ax ? HalfPi - a : a;
+    a = x < 0 ? Pi - a : a;
+    return copysignf(a, y);
+}
+
+/**
+ * @brief Sine and cosine of an angle
+ */
+inline void sinCosFast(float angle, float *sine, float *cosine)
+{
+    // Reduce to [-pi/4, pi/4] around the nearest quarter turn. The
+    // comparison also maps NaN to 0, keeping the conversion defined.
+    float turns = angle * TwoOverPi;
+    turns = (turns > -MaxQuadrant && turns < MaxQuadrant) ? turns : 0;
+    const int quadrant = static_cast<int>(turns + (turns < 0 ? -0.5f : 0.5f));
+    const float k = static_cast<float>(quadrant);
+    const float r = ((angle - k * HalfPi1) - k * HalfPi2) - k * HalfPi3;
+
+    const float z = r * r;
+    const float s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z
+                     - 1.6666654611e-1f) * z * r + r;
+    const float c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z
+                     + 4.166664568298827e-2f) * z * z - 0.5f * z + 1;
+
+    const bool swap = (quadrant & 1) != 0;
+    const float sr = swap ? c : s;
+    const float cr = swap ? s : c;
+    *sine = (quadrant & 2) ? -sr : sr;
+    *cosine = ((quadrant + 1) & 2) ? -cr : cr;
+}
+
+/**
+ * @brief quaternionToDcm() with the element arrays as restrict qualified
+ *        parameters, the compiler ignores restrict qualified locals
+ */
+void quaternionToDcmElements(const float *__restrict w, const float *__restrict x,
+                             const float *__restrict y, const float *__restrict z,
+                             float *__restrict dcm00, float *__restrict dcm01, float *__restrict dcm02,
+                             float *__restrict dcm10, float *__restrict dcm11, float *__restrict dcm12,
+                             float *__restrict dcm20, float *__restrict dcm21, float *__restrict dcm22,
+                             int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const float a = w[i], b = x[i], c = y[i], d = z[i];
+        const float aSq = a * a, bSq = b * b, cSq = c * c, dSq = d * d;
+        dcm00[i] = aSq + bSq - cSq - dSq;
+        dcm01[i] = 2 * (b * c - a * d);
+        dcm02[i] = 2 * (a * c + b * d);
+        dcm10[i] = 2 * (b * c + a * d);
+        dcm11[i] = aSq - bSq + cSq - dSq;
+        dcm12[i] = 2 * (c * d - a * b);
+        dcm20[i] = 2 * (b * d - a * c);
+        dcm21[i] = 2 * (a * b + c * d);
+        dcm22[i] = aSq - bSq - cSq + dSq;
+    }
+}
+}
+
+void AttitudeKernels::quaternionToEuler(const float *__restrict w, const float *__restrict x,
+                                        const float *__restrict y, const float *__restrict z,
+                                        float *__restrict roll, float *__restrict pitch,
+                                        float *__restrict yaw, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const float a = w[i], b = x[i], c = y[i], d = z[i];
+        const float aSq = a * a, bSq = b * b, cSq = c * c, dSq = d * d;
+
+        // Elements of the rotation matrix mavlink_quaternion_to_dcm() makes
+        const float dcm00 = aSq + bSq - cSq - dSq;
+        const float dcm01 = 2 * (b * c - a * d);
+        const float dcm10 = 2 * (b * c + a * d);
+        const float dcm11 = aSq - bSq + cSq - dSq;
+        const float dcm20 = 2 * (b * d - a * c);
+        const float dcm21 = 2 * (a * b + c * d);
+        const float dcm22 = aSq - bSq - cSq + dSq;
+
+        // cos(pitch) from the small elements keeps pitch precise near the
+        // gimbal lock, where asin(-dcm20) loses it
+        const float theta = atan2Fast(-dcm20, sqrtf(dcm00 * dcm00 + dcm10 * dcm10));
+        // Only yaw - roll (pitch pi/2) or yaw + roll (pitch -pi/2) is
+        // defined at the lock, atan2(-dcm01, dcm11) gives it in both cases
+        const bool locked = fabsf(theta) > HalfPi - GimbalLockMargin;
+        roll[i] = locked ? 0 : atan2Fast(dcm21, dcm22);
+        pitch[i] = theta;
+        yaw[i] = atan2Fast(locked ? -dcm01 : dcm10, locked ? dcm11 : dcm00);
+    }
+}
+
+void AttitudeKernels::quaternionToDcm(const float *w, const float *x, const float *y, const float *z,
+                                      float *const dcm[3][3], int count)
+{
+    quaternionToDcmElements(w, x, y, z,
+                            dcm[0][0], dcm[0][1], dcm[0][2],
+                            dcm[1][0], dcm[1][1], dcm[1][2],
+                            dcm[2][0], dcm[2][1], dcm[2][2], count);
+}
+
+void AttitudeKernels::eulerToQuaternion(const float *__restrict roll, const float *__restrict pitch,
+                                        const float *__restrict yaw,
+                                        float *__restrict w, float *__restrict x,
+                                        float *__restrict y, float *__restrict z, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        float sinPhi, cosPhi, sinTheta, cosTheta, sinPsi, cosPsi;
+        sinCosFast(roll[i] * 0.5f, &sinPhi, &cosPhi);
+        sinCosFast(pitch[i] * 0.5f, &sinTheta, &cosTheta);
+        sinCosFast(yaw[i] * 0.5f, &sinPsi, &cosPsi);
+        w[i] = cosPhi * cosTheta * cosPsi + sinPhi * sinTheta * sinPsi;
+        x[i] = sinPhi * cosTheta * cosPsi - cosPhi * sinTheta * sinPsi;
+        y[i] = cosPhi * sinTheta * cosPsi + sinPhi * cosTheta * sinPsi;
+        z[i] = cosPhi * cosTheta * sinPsi - sinPhi * sinTheta * cosPsi;
+    }
+}
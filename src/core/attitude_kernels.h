@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+
+/**
+ * @file attitude_kernels.h
+ * @brief File contains batch attitude conversions over arrays of samples
+ */
+
+#ifndef ATTITUDE_KERNELS_H
+#define ATTITUDE_KERNELS_H
+
+/**
+ * @brief Attitude conversions over batches of samples in SoA layout
+ *
+ * Batch counterparts of mavlink_quaternion_to_euler(),
+ * mavlink_quaternion_to_dcm() and mavlink_euler_to_quaternion() from
+ * mavlink_conversions.h, with the same conventions: quaternions are [w, x, y,
+ * z] ordered, angles are in radians, ZYX rotation order. Every component is
+ * a separate array and the loops have no calls or branches, so the compiler
+ * vectorises them. atan2, sin and cos are polynomial approximations, the
+ * results differ from the scalar functions by about the float rounding.
+ *
+ * Input and output arrays must not overlap.
+ */
+namespace AttitudeKernels {
+
+/**
+ * @brief SoA batch of attitude samples
+ */
+struct Batch
+{
+    /**
+     * @brief Number of samples in a batch
+     */
+    static const int Capacity = 64;
+
+    float w[Capacity];
+    float x[Capacity];
+    float y[Capacity];
+    float z[Capacity];
+    float roll[Capacity];
+    float pitch[Capacity];
+    float yaw[Capacity];
+};
+
+/**
+ * @brief Convert quaternions to euler angles
+ *
+ * Near the gimbal lock (|pitch| within 1e-3 of pi/2) roll is 0 and yaw
+ * holds the whole rotation about the vertical axis, as in
+ * mavlink_dcm_to_euler(). Unlike it, yaw is also right at pitch -pi/2 and
+ * pitch is never NaN for slightly denormalised quaternions.
+ *
+ * @param w, x, y, z unit quaternion components
+ * @param roll roll angles in [-pi, pi]
+ * @param pitch pitch angles in [-pi/2, pi/2]
+ * @param yaw yaw angles in [-pi, pi]
+ * @param count number of samples
+ */
+void quaternionToEuler(const float *w, const float *x, const float *y, const float *z,
+                       float *roll, float *pitch, float *yaw, int count);
+
+/**
+ * @brief Convert quaternions to rotation matrices
+ * @param w, x, y, z unit quaternion components
+ * @param dcm rotation matrix element arrays, dcm[i][j] holds the element at
+ *            row i, column j of every sample
+ * @param count number of samples
+ */
+void quaternionToDcm(const float *w, const float *x, const float *y, const float *z,
+                     float *const dcm[3][3], int count);
+
+/**
+ * @brief Convert euler angles to quaternions
+ *
+ * Angles must be finite. The precision is kept for angles within a few
+ * turns, which is all MAVLink sources report.
+ *
+ * @param roll roll angles
+ * @param pitch pitch angles
+ * @param yaw yaw angles
+ * @param w, x, y, z unit quaternion components
+ * @param count number of samples
+ */
+void eulerToQuaternion(const float *roll, const float *pitch, const float *yaw,
+                       float *w, float *x, float *y, float *z, int count);
+
+/**
+ * @brief Convert the quaternions of a batch to its euler angles
+ * @param batch batch with w, x, y and z set
+ * @param count number of samples in the batch
+ */
+inline void quaternionToEuler(Batch *batch, int count)
+{
+    quaternionToEuler(batch->w, batch->x, batch->y, batch->z,
+                      batch->roll, batch->pitch, batch->yaw, count);
+}
+
+/**
+ * @brief Convert the euler angles of a batch to its quaternions
+ * @param batch batch with roll, pitch and yaw set
+ * @param count number of samples in the batch
+ */
+inline void eulerToQuaternion(Batch *batch, int count)
+{
+    eulerToQuaternion(batch->roll, batch->pitch, batch->yaw,
+                      batch->w, batch->x, batch->y, batch->z, count);
+}
+
+} // namespace AttitudeKernels
+
+#endif // #ifndef ATTITUDE_KERNELS_H
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "attitude_predictor.h"
+#include "quaternion.h"
+
+#include <math.h>
+
+namespace {
+const float TwoPi = 6.28318530717959f;
+}
+
+AttitudeSample AttitudePredictor::predict(const AttitudeSample &sample, qint64 horizonNs)
+{
+    horizonNs = qBound(-MaxHorizonNs, horizonNs, MaxHorizonNs);
+    const float dt = horizonNs * 1e-9f;
+    const float p = sample.rollspeed;
+    const float q = sample.pitchspeed;
+    const float r = sample.yawspeed;
+
+    AttitudeSample predicted = sample;
+    predicted.predictionNs = horizonNs;
+
+    const float step = sqrtf(p * p + q * q + r * r) * fabsf(dt);
+    const float cosPitch = cosf(sample.pitch);
+    if (step < MaxEulerStep && fabsf(cosPitch) > 0.01f) {
+        const float sinRoll = sinf(sample.roll);
+        const float cosRoll = cosf(sample.roll);
+        const float yawRate = (sinRoll * q + cosRoll * r) / cosPitch;
+        predicted.roll = remainderf(sample.roll + (p + sinf(sample.pitch) * yawRate) * dt,
+                                    TwoPi);
+        predicted.pitch = sample.pitch + (cosRoll * q - sinRoll * r) * dt;
+        predicted.yaw = remainderf(sample.yaw + yawRate * dt, TwoPi);
+        return predicted;
+    }
+
+    // Body rates rotate the attitude in the body frame
+    const Quaternion rotation = Quaternion::fromEuler(sample.roll, sample.pitch, sample.yaw)
+            * Quaternion::fromRotationVector(p * dt, q * dt, r * dt);
+    rotation.toEuler(&predicted.roll, &predicted.pitch, &predicted.yaw);
+    return predicted;
+}
+
+qint64 LinkLatencyEstimator::update(quint32 timeBootMs, qint64 rxTimeNs)
+{
+    const qint64 offsetNs = rxTimeNs - static_cast<qint64>(timeBootMs) * 1000000;
+    // Autopilot time going back means it rebooted
+    if (m_samples == 0 || timeBootMs < m_lastTimeBootMs) {
+        m_windowStartNs = rxTimeNs;
+        m_minOffsetNs = offsetNs;
+        m_previousMinOffsetNs = offsetNs;
+        m_samples = 0;
+    }
+    m_samples++;
+    m_lastTimeBootMs = timeBootMs;
+
+    if (rxTimeNs - m_windowStartNs >= WindowNs) {
+        m_windowStartNs = rxTimeNs;
+        m_previousMinOffsetNs = m_minOffsetNs;
+        m_minOffsetNs = offsetNs;
+    }
+    m_minOffsetNs = qMin(m_minOffsetNs, offsetNs);
+    return offsetNs - qMin(m_minOffsetNs, m_previousMinOffsetNs);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_predictor.h
+ * @brief File contains the latency compensation of attitude samples - AttitudePredictor
+ */
+
+#ifndef ATTITUDE_PREDICTOR_H
+#define ATTITUDE_PREDICTOR_H
+
+#include <QtGlobal>
+
+#include "attitude_sample.h"
+
+/**
+ * @brief Projection of attitude samples forward in time
+ *
+ * The angular speeds of a sample are assumed constant over the horizon.
+ * Short horizons use one step of the euler angle kinematics, longer ones
+ * (or ones close to the gimbal lock) integrate the body rates as a
+ * quaternion rotation, which is exact for a constant rate.
+ */
+namespace AttitudePredictor {
+
+/**
+ * @brief Longest horizon a sample is projected over (ns)
+ *
+ * Extrapolating further is more likely to add error than to remove it.
+ */
+const qint64 MaxHorizonNs = 500000000;
+
+/**
+ * @brief Rotation over the horizon up to which euler kinematics are used (rad)
+ */
+const float MaxEulerStep = 0.02f;
+
+/**
+ * @brief Project a sample forward
+ * @param sample measured sample
+ * @param horizonNs time to project over (ns), limited to MaxHorizonNs
+ * @return Sample with projected angles and predictionNs set
+ */
+AttitudeSample predict(const AttitudeSample &sample, qint64 horizonNs);
+
+}
+
+/**
+ * @brief Live estimate of the MAVLink link delay
+ *
+ * The difference between the host receive time and the autopilot time of
+ * a sample is the clock offset plus the delay of the sample. Its minimum
+ * over a sliding window belongs to the fastest sample, so the excess of a
+ * sample over the minimum is how much later than the fastest one it
+ * arrived, e.g. because the autopilot sent it in a burst or the link
+ * buffered it. The window follows the drift of the two clocks.
+ */
+class LinkLatencyEstimator
+{
+public:
+    /**
+     * @brief Length of one of the two halves of the minimum window (ns)
+     */
+    static const qint64 WindowNs = 10000000000LL;
+
+    /**
+     * @brief Estimate the delay of a sample
+     * @param timeBootMs autopilot time of the sample (ms since boot)
+     * @param rxTimeNs host monotonic receive time (ns)
+     * @return Delay beyond the fastest recent sample (ns)
+     */
+    qint64 update(quint32 timeBootMs, qint64 rxTimeNs);
+
+    /**
+     * @brief Forget the recent samples, e.g. after the autopilot rebooted
+     */
+    void reset() { m_samples = 0; }
+
+private:
+    /**
+     * @brief Samples seen since the last reset
+     */
+    quint64 m_samples = 0;
+    /**
+     * @brief Autopilot time of the last sample (ms)
+     */
+    quint32 m_lastTimeBootMs = 0;
+    /**
+     * @brief Start of the current window half (ns)
+     */
+    qint64 m_windowStartNs = 0;
+    /**
+     * @brief Minimal offsets of the current and the previous window halves (ns)
+     */
+    qint64 m_minOffsetNs = 0;
+    qint64 m_previousMinOffsetNs = 0;
+};
+
+#endif // #ifndef ATTITUDE_PREDICTOR_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_record.h
+ * @brief File contains the binary attitude record sent by datagram outputs
+ *
+ * Plain C header, may be copied into consumer code.
+ */
+
+#ifndef ATTITUDE_RECORD_H
+#define ATTITUDE_RECORD_H
+
+#include <stdint.h>
+
+/**
+ * @brief Value of AttitudeRecord::magic
+ */
+#define ATTITUDE_RECORD_MAGIC 0xA77Fu
+/**
+ * @brief Current value of AttitudeRecord::version
+ */
+#define ATTITUDE_RECORD_VERSION 1u
+
+/**
+ * @brief Record flag: quaternion fields are valid
+ */
+#define ATTITUDE_RECORD_FLAG_QUATERNION 0x01u
+/**
+ * @brief Record flag: attitude is projected forward by predictionUs
+ */
+#define ATTITUDE_RECORD_FLAG_PREDICTED 0x02u
+
+/**
+ * @brief Binary attitude record, 64 bytes, little-endian
+ *
+ * Every field is naturally aligned. Consumers must check magic and version
+ * and ignore flags they don't know.
+ */
+typedef struct AttitudeRecord
+{
+    /** ATTITUDE_RECORD_MAGIC */
+    uint16_t magic;
+    /** ATTITUDE_RECORD_VERSION */
+    uint8_t version;
+    /** ATTITUDE_RECORD_FLAG_* */
+    uint8_t flags;
+    /** Sequence number, incremented by every record of a sender */
+    uint32_t seq;
+    /** Host receive time (us since the epoch) */
+    int64_t timeUs;
+    /** Autopilot time since boot (ms) */
+    uint32_t timeBootMs;
+    /** Roll angle (rad) */
+    float roll;
+    /** Pitch angle (rad) */
+    float pitch;
+    /** Yaw angle (rad) */
+    float yaw;
+    /** Roll angular speed (rad/s) */
+    float rollspeed;
+    /** Pitch angular speed (rad/s) */
+    float pitchspeed;
+    /** Yaw angular speed (rad/s) */
+    float yawspeed;
+    /** Attitude quaternion (w, x, y, z) */
+    float q[4];
+    /** Time the attitude is projected forward over (us), zero if measured */
+    int32_t predictionUs;
+} AttitudeRecord;
+
+#endif /* #ifndef ATTITUDE_RECORD_H */
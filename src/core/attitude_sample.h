@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_sample.h
+ * @brief File contains a declaration of the attitude sample passed to outputs
+ */
+
+#ifndef ATTITUDE_SAMPLE_H
+#define ATTITUDE_SAMPLE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Attitude sample decoded from the MAVLink stream
+ */
+struct AttitudeSample
+{
+    /**
+     * @brief Autopilot timestamp (milliseconds since boot)
+     */
+    quint32 timeBootMs = 0;
+    /**
+     * @brief Host monotonic time the sample was received (ns)
+     */
+    qint64 rxTimeNs = 0;
+    /**
+     * @brief Roll angle (rad)
+     */
+    float roll = 0;
+    /**
+     * @brief Pitch angle (rad)
+     */
+    float pitch = 0;
+    /**
+     * @brief Yaw angle (rad)
+     */
+    float yaw = 0;
+    /**
+     * @brief Roll angular speed (rad/s)
+     */
+    float rollspeed = 0;
+    /**
+     * @brief Pitch angular speed (rad/s)
+     */
+    float pitchspeed = 0;
+    /**
+     * @brief Yaw angular speed (rad/s)
+     */
+    float yawspeed = 0;
+    /**
+     * @brief Host monotonic time the autopilot measured the sample (ns)
+     *
+     * 0 unless the autopilot clock is synchronised, see ClockSync.
+     */
+    qint64 timeNs = 0;
+    /**
+     * @brief Estimated delay of the sample on the MAVLink link (ns)
+     *
+     * rxTimeNs - timeNs if the clocks are synchronised, otherwise the delay
+     * beyond the fastest recent sample.
+     */
+    qint64 latencyNs = 0;
+    /**
+     * @brief Time the angles were projected forward over (ns), 0 if measured
+     */
+    qint64 predictionNs = 0;
+};
+
+#endif // #ifndef ATTITUDE_SAMPLE_H
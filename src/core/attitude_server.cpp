@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "attitude_server.h"
+#include "monotonic_clock.h"
+
+#include <QUrlQuery>
+
+#include <QDebug>
+
+AttitudeServer::AttitudeServer(QObject *parent) :
+    AttitudeSink(parent), m_server(this)
+{
+    connect(&m_server, &QTcpServer::newConnection,
+            this, &AttitudeServer::handleNewConnection);
+}
+
+AttitudeServer::~AttitudeServer()
+{
+    close();
+}
+
+bool AttitudeServer::open()
+{
+    if (!m_server.listen(m_address, m_port)) {
+        qWarning().noquote() << tr("Warning: Failed to listen on %1:%2 (%3).")
+                                .arg(m_address.toString())
+                                .arg(m_port)
+                                .arg(m_server.errorString());
+        return false;
+    }
+    return true;
+}
+
+void AttitudeServer::close()
+{
+    m_server.close();
+    for (const Client &client : m_clients) {
+        client.socket->disconnect(this);
+        client.socket->abort();
+        client.socket->deleteLater();
+    }
+    m_clients.clear();
+}
+
+void AttitudeServer::write(const AttitudeSample &sample)
+{
+    m_eventSeq++;
+
+    char *event = Q_NULLPTR;
+    int eventSize = 0;
+    for (const Client &client : m_clients) {
+        if (!client.streaming || client.socket->bytesToWrite() > MaxStreamBacklog) {
+            continue;
+        }
+        if (!event) {
+            event = m_buffer;
+            char *out = FastFormat::appendLiteral(event, "data: ");
+            out = AttitudeJson::append(out, sample, m_eventSeq);
+            out = FastFormat::appendLiteral(out, "\n\n");
+            eventSize = static_cast<int>(out - event);
+        }
+        client.socket->write(event, eventSize);
+    }
+}
+
+void AttitudeServer::handleNewConnection()
+{
+    while (m_server.hasPendingConnections()) {
+        QTcpSocket *socket = m_server.nextPendingConnection();
+        if (m_clients.size() >= MaxClients) {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::readyRead,
+                this, &AttitudeServer::handleReadyRead);
+        connect(socket, &QTcpSocket::disconnected,
+                this, &AttitudeServer::handleDisconnected);
+        Client client;
+        client.socket = socket;
+        m_clients.append(client);
+    }
+}
+
+void AttitudeServer::handleReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    Client *client = findClient(socket);
+    if (!client) {
+        return;
+    }
+    client->request.append(socket->readAll());
+    while (!client->streaming) {
+        const int end = client->request.indexOf("\r\n\r\n");
+        if (end < 0) {
+            if (client->request.size() > MaxRequestSize) {
+                socket->abort();
+            }
+            return;
+        }
+        const QByteArray request = client->request.left(end);
+        client->request.remove(0, end + 4);
+        if (!handleRequest(*client, request)) {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+    // Stream clients don't send further requests
+    client->request.clear();
+}
+
+void AttitudeServer::handleDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    for (int i = 0; i < m_clients.size(); ++i) {
+        if (m_clients[i].socket == socket) {
+            m_clients.removeAt(i);
+            break;
+        }
+    }
+    socket->deleteLater();
+}
+
+AttitudeServer::Client *AttitudeServer::findClient(QTcpSocket *socket)
+{
+    for (Client &client : m_clients) {
+        if (client.socket == socket) {
+            return &client;
+        }
+    }
+    return Q_NULLPTR;
+}
+
+bool AttitudeServer::handleRequest(Client &client, const QByteArray &request)
+{
+    const int lineEnd = request.indexOf("\r\n");
+    const QList<QByteArray> requestLine = request.left(lineEnd).split(' ');
+    if (requestLine.size() != 3) {
+        sendResponse(client.socket, "400 Bad Request", "{\"error\":\"bad request\"}", true);
+        return false;
+    }
+    const QByteArray &method = requestLine[0];
+    const QByteArray &target = requestLine[1];
+    const QByteArray headers = lineEnd < 0 ? QByteArray() : request.mid(lineEnd).toLower();
+    const bool close = requestLine[2] == "HTTP/1.0"
+            ? !headers.contains("\r\nconnection: keep-alive")
+            : headers.contains("\r\nconnection: close");
+
+    if (method != "GET") {
+        sendResponse(client.socket, "405 Method Not Allowed", "{\"error\":\"method not allowed\"}", true);
+        return false;
+    }
+
+    const int queryStart = target.indexOf('?');
+    const QByteArray path = target.left(queryStart);
+    const QByteArray query = queryStart < 0 ? QByteArray() : target.mid(queryStart + 1);
+
+    if (path == "/attitude/stream") {
+        client.socket->write("HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/event-stream\r\n"
+                             "Cache-Control: no-cache\r\n"
+                             "Connection: keep-alive\r\n\r\n");
+        client.streaming = true;
+        return true;
+    }
+
+    AttitudeSample sample;
+    quint64 seq = 0;
+    if (path == "/attitude/latest") {
+        if (!m_history || !m_history->latest(&sample, Q_NULLPTR, &seq)) {
+            sendResponse(client.socket, "503 Service Unavailable", "{\"error\":\"no data\"}", close);
+            return !close;
+        }
+    } else if (path == "/attitude") {
+        bool ok = false;
+        const qint64 timeUs = QUrlQuery(QString::fromLatin1(query))
+                .queryItemValue("t").toLongLong(&ok);
+        if (!ok) {
+            sendResponse(client.socket, "400 Bad Request", "{\"error\":\"bad time\"}", close);
+            return !close;
+        }
+        const qint64 timeNs = timeUs * 1000 - MonotonicClock::systemOffset();
+        if (!m_history || !m_history->at(timeNs, &sample, Q_NULLPTR, &seq)) {
+            sendResponse(client.socket, "404 Not Found", "{\"error\":\"out of history\"}", close);
+            return !close;
+        }
+    } else {
+        sendResponse(client.socket, "404 Not Found", "{\"error\":\"not found\"}", close);
+        return !close;
+    }
+
+    const char *end = AttitudeJson::append(m_buffer, sample, seq);
+    sendResponse(client.socket, "200 OK", QByteArray::fromRawData(m_buffer, end - m_buffer), close);
+    return !close;
+}
+
+void AttitudeServer::sendResponse(QTcpSocket *socket, const char *status,
+                                  const QByteArray &body, bool close)
+{
+    QByteArray response;
+    response.reserve(160 + body.size());
+    response.append("HTTP/1.1 ");
+    response.append(status);
+    response.append("\r\nContent-Type: application/json\r\n"
+                    "Cache-Control: no-cache\r\n");
+    if (close) {
+        response.append("Connection: close\r\n");
+    }
+    response.append("Content-Length: ");
+    response.append(QByteArray::number(body.size()));
+    response.append("\r\n\r\n");
+    response.append(body);
+    socket->write(response);
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_server.h
+ * @brief File contains a declaration of the embedded attitude HTTP server - AttitudeServer
+ */
+
+#ifndef ATTITUDE_SERVER_H
+#define ATTITUDE_SERVER_H
+
+#include <QHostAddress>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "attitude_history.h"
+#include "attitude_json.h"
+#include "attitude_sink.h"
+
+/**
+ * @brief Attitude output serving samples to clients on request
+ *
+ * A small HTTP/1.1 server with the endpoints:
+ * - GET /attitude/latest - the latest sample;
+ * - GET /attitude?t=<us> - the sample at a host time (us since the epoch),
+ *   interpolated between the two nearest samples of the AttitudeHistory;
+ * - GET /attitude/stream - Server-Sent Events, one "data:" event per sample.
+ *
+ * Lookups read the history of all received samples set with setHistory(),
+ * which is shared with the MAVLink I/O thread, so the rate and decimation
+ * policy of the output only applies to the event stream.
+ *
+ * Samples are JSON objects in the AttitudeJson format. Keep-alive
+ * connections are supported. Events are skipped for a stream client which
+ * doesn't keep up.
+ */
+class AttitudeServer : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Maximal number of client connections
+     */
+    static const int MaxClients = 16;
+    /**
+     * @brief Maximal size of a request
+     */
+    static const int MaxRequestSize = 4096;
+    /**
+     * @brief Unsent bytes of a stream client above which events are skipped
+     */
+    static const qint64 MaxStreamBacklog = 16384;
+
+    AttitudeServer(QObject *parent = Q_NULLPTR);
+    virtual ~AttitudeServer();
+
+    /**
+     * @brief Set the address to listen on
+     * @param address local address, e.g. QHostAddress::LocalHost
+     * @param port TCP port
+     */
+    void setListenAddress(const QHostAddress &address, quint16 port)
+    {
+        m_address = address;
+        m_port = port;
+    }
+
+    /**
+     * @brief Set the attitude history to answer lookups from
+     *
+     * The history must outlive the server. Must be called before open().
+     *
+     * @param history recent attitude samples, e.g. Core::history()
+     */
+    void setHistory(const AttitudeHistory *history) { m_history = history; }
+
+    /**
+     * @brief Start listening
+     * @return true on success, false otherwise
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Stop listening and disconnect all clients
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Push a sample to stream clients
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+
+private slots:
+    /**
+     * @brief Accept pending connections
+     */
+    void handleNewConnection();
+    /**
+     * @brief Read and answer requests of a client
+     */
+    void handleReadyRead();
+    /**
+     * @brief Forget a disconnected client
+     */
+    void handleDisconnected();
+
+private:
+    /**
+     * @brief Client connection
+     */
+    struct Client {
+        QTcpSocket *socket = Q_NULLPTR;
+        /**
+         * @brief Unparsed request data
+         */
+        QByteArray request;
+        /**
+         * @brief Whether the client receives the event stream
+         */
+        bool streaming = false;
+    };
+
+    /**
+     * @brief Find the client of a socket
+     * @param socket client socket
+     * @return Client, Q_NULLPTR if not found
+     */
+    Client *findClient(QTcpSocket *socket);
+    /**
+     * @brief Answer one request
+     * @param client requesting client
+     * @param request request line and headers without the final empty line
+     * @return true to keep the connection, false to close it
+     */
+    bool handleRequest(Client &client, const QByteArray &request);
+    /**
+     * @brief Send a response
+     * @param socket client socket
+     * @param status status line after the version, e.g. "200 OK"
+     * @param body JSON body
+     * @param close whether the connection will be closed
+     */
+    void sendResponse(QTcpSocket *socket, const char *status,
+                      const QByteArray &body, bool close);
+
+private:
+    /**
+     * @brief Local address to listen on
+     */
+    QHostAddress m_address = QHostAddress::LocalHost;
+    /**
+     * @brief Local TCP port
+     */
+    quint16 m_port = 8125;
+    /**
+     * @brief Listening socket
+     */
+    QTcpServer m_server;
+    /**
+     * @brief Connected clients
+     */
+    QList<Client> m_clients;
+
+    /**
+     * @brief Recent samples, Q_NULLPTR if not set
+     */
+    const AttitudeHistory *m_history = Q_NULLPTR;
+    /**
+     * @brief Sequence number of the latest stream event
+     */
+    quint64 m_eventSeq = 0;
+
+    /**
+     * @brief Response and event buffer
+     */
+    char m_buffer[AttitudeJson::MaxLength + 16];
+};
+
+#endif // #ifndef ATTITUDE_SERVER_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_shm.h
+ * @brief File contains the shared memory attitude segment layout and reader
+ *
+ * Plain C header (GCC/Clang), may be copied into consumer code together
+ * with attitude_record.h. Link with -lrt on older glibc.
+ *
+ * Reading the latest sample:
+ * @code
+ * const AttitudeShm *shm = attitude_shm_attach("/attfeeder");
+ * AttitudeRecord record;
+ * if (shm && attitude_shm_read_latest(shm, &record)) {
+ *     use(record.roll, record.pitch, record.yaw);
+ * }
+ * @endcode
+ */
+
+#ifndef ATTITUDE_SHM_H
+#define ATTITUDE_SHM_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "attitude_record.h"
+
+/**
+ * @brief Value of AttitudeShm::magic
+ */
+#define ATTITUDE_SHM_MAGIC 0x41545348u
+/**
+ * @brief Current value of AttitudeShm::version
+ */
+#define ATTITUDE_SHM_VERSION 1u
+/**
+ * @brief Number of recent records kept in AttitudeShm::ring
+ */
+#define ATTITUDE_SHM_RING_SIZE 64u
+/**
+ * @brief Attempts of a reader to get a consistent copy of a slot
+ */
+#define ATTITUDE_SHM_READ_TRIES 16
+
+/**
+ * @brief Record guarded by a seqlock
+ *
+ * The writer makes seq odd, copies the record and makes seq even again.
+ * A copy is consistent if seq was even and unchanged around it.
+ */
+typedef struct AttitudeShmSlot
+{
+    /** Seqlock counter, odd while the record is being written */
+    uint32_t seq;
+    /** Reserved, zero */
+    uint32_t reserved;
+    /** Attitude record */
+    AttitudeRecord record;
+} AttitudeShmSlot;
+
+/**
+ * @brief Shared memory segment published by the feeder
+ *
+ * There is a single writer. Readers only map the segment and never write
+ * to it, so any number of them may attach.
+ */
+typedef struct AttitudeShm
+{
+    /** ATTITUDE_SHM_MAGIC */
+    uint32_t magic;
+    /** ATTITUDE_SHM_VERSION */
+    uint32_t version;
+    /** ATTITUDE_SHM_RING_SIZE */
+    uint32_t ringSize;
+    /** Reserved, zero */
+    uint32_t reserved;
+    /** Number of records written so far, the newest is in ring[(count - 1) % ringSize] */
+    uint64_t count;
+    /** Latest record */
+    AttitudeShmSlot latest;
+    /** Recent records */
+    AttitudeShmSlot ring[ATTITUDE_SHM_RING_SIZE];
+} AttitudeShm;
+
+/**
+ * @brief Get a consistent copy of a slot
+ * @param slot slot to read
+ * @param record output record
+ * @return 1 on success, 0 if the slot kept changing or was never written
+ */
+static inline int attitude_shm_read_slot(const AttitudeShmSlot *slot, AttitudeRecord *record)
+{
+    int i;
+    for (i = 0; i < ATTITUDE_SHM_READ_TRIES; ++i) {
+        const uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (before & 1u) {
+            continue;
+        }
+        memcpy(record, &slot->record, sizeof(*record));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == before) {
+            return record->magic == ATTITUDE_RECORD_MAGIC;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the latest record
+ * @param shm attached segment
+ * @param record output record
+ * @return 1 on success, 0 if there is no record yet or it kept changing
+ */
+static inline int attitude_shm_read_latest(const AttitudeShm *shm, AttitudeRecord *record)
+{
+    return attitude_shm_read_slot(&shm->latest, record);
+}
+
+/**
+ * @brief Get recent records, newest first
+ * @param shm attached segment
+ * @param records output records
+ * @param max maximal number of records to read
+ * @return Number of records read
+ */
+static inline unsigned attitude_shm_read_recent(const AttitudeShm *shm, AttitudeRecord *records, unsigned max)
+{
+    const uint64_t count = __atomic_load_n(&shm->count, __ATOMIC_ACQUIRE);
+    unsigned read = 0;
+    while (read < max && read < shm->ringSize && read < count) {
+        const uint64_t index = count - 1 - read;
+        if (!attitude_shm_read_slot(&shm->ring[index % shm->ringSize], &records[read])) {
+            break;
+        }
+        /* Stop at slots the writer has already reused */
+        if (read > 0 && (uint32_t)(records[read - 1].seq - records[read].seq) != 1u) {
+            break;
+        }
+        read++;
+    }
+    return read;
+}
+
+/**
+ * @brief Map the segment read-only
+ * @param name segment name, e.g. "/attfeeder"
+ * @return Mapped segment, NULL on failure or layout mismatch
+ */
+static inline const AttitudeShm *attitude_shm_attach(const char *name)
+{
+    const AttitudeShm *shm;
+    struct stat info;
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(AttitudeShm)) {
+        close(fd);
+        return NULL;
+    }
+    shm = (const AttitudeShm *)mmap(NULL, sizeof(AttitudeShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == (const AttitudeShm *)MAP_FAILED) {
+        return NULL;
+    }
+    if (shm->magic != ATTITUDE_SHM_MAGIC || shm->version != ATTITUDE_SHM_VERSION) {
+        munmap((void *)shm, sizeof(AttitudeShm));
+        return NULL;
+    }
+    return shm;
+}
+
+/**
+ * @brief Unmap the segment
+ * @param shm segment returned by attitude_shm_attach()
+ */
+static inline void attitude_shm_detach(const AttitudeShm *shm)
+{
+    munmap((void *)shm, sizeof(AttitudeShm));
+}
+
+#endif /* #ifndef ATTITUDE_SHM_H */
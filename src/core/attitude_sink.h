@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file attitude_sink.h
+ * @brief File contains a declaration of the attitude output interface - AttitudeSink
+ */
+
+#ifndef ATTITUDE_SINK_H
+#define ATTITUDE_SINK_H
+
+#include <QObject>
+
+#include "attitude_sample.h"
+
+/**
+ * @brief Output which attitude samples are sent to
+ *
+ * Sinks live on the Core thread. write() must not block. A sink which can't
+ * take more samples for now reports isBusy() and emits ready() once it can,
+ * meanwhile its samples wait in its SinkChannel.
+ */
+class AttitudeSink : public QObject
+{
+    Q_OBJECT
+public:
+    AttitudeSink(QObject *parent = Q_NULLPTR) : QObject(parent) {}
+    virtual ~AttitudeSink() {}
+
+    /**
+     * @brief Start the output
+     * @return true on success, false otherwise
+     */
+    virtual bool open() = 0;
+    /**
+     * @brief Stop the output
+     */
+    virtual void close() = 0;
+    /**
+     * @brief Send an attitude sample
+     * @param sample attitude sample with angles in radians
+     */
+    virtual void write(const AttitudeSample &sample) = 0;
+
+    /**
+     * @brief Check if the sink should not be written to for now
+     * @return true if write() would have to drop or hold back the sample
+     */
+    virtual bool isBusy() const { return false; }
+
+    /**
+     * @brief Get the average time the sink takes to deliver a sample
+     *
+     * E.g. the response time of HTTP requests. A growing delivery time
+     * means samples queue up somewhere behind the sink.
+     *
+     * @return Delivery time (ns), 0 if unknown
+     */
+    virtual qint64 deliveryTimeNs() const { return 0; }
+
+    /**
+     * @brief Get the number of samples the sink dropped itself
+     *
+     * E.g. while its connection is down. Samples dropped from the
+     * SinkChannel queue are not included.
+     *
+     * @return Dropped samples count
+     */
+    virtual quint64 droppedSamples() const { return 0; }
+
+signals:
+    /**
+     * @brief Emitted when a busy sink can take samples again
+     */
+    void ready();
+};
+
+#endif // #ifndef ATTITUDE_SINK_H
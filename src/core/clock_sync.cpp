@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "clock_sync.h"
+#include "monotonic_clock.h"
+
+#include <QDebug>
+
+#include <common/mavlink.h>
+
+namespace {
+/**
+ * @brief Largest believable drift between the clocks
+ */
+const double MaxDrift = 0.001;
+}
+
+ClockSync::ClockSync(MavlinkInterface *mavlinkInterface) :
+    QObject(mavlinkInterface), m_mavlinkInterface(mavlinkInterface), m_timer(this)
+{
+    connect(&m_timer, &QTimer::timeout, this, &ClockSync::sendRequest);
+}
+
+qint64 ClockSync::toHostTime(qint64 remoteNs) const
+{
+    // Solve remote = host + offset + drift * (host - reference) for host
+    return m_referenceNs + static_cast<qint64>(
+                (remoteNs - m_offsetNs - m_referenceNs) / (1 + m_drift));
+}
+
+void ClockSync::handleFrames(const MavlinkFrame *frames, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        switch (frames[i].msgid()) {
+        case MAVLINK_MSG_ID_TIMESYNC:
+            handleTimesync(frames[i]);
+            break;
+        case MAVLINK_MSG_ID_SYSTEM_TIME:
+            handleSystemTime(frames[i]);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ClockSync::handleConnectionChanged()
+{
+    if (m_timesyncEnabled && m_mavlinkInterface->connected()) {
+        m_timer.start(m_synchronized ? TimesyncInterval : FastTimesyncInterval);
+    } else {
+        m_timer.stop();
+    }
+}
+
+void ClockSync::sendRequest()
+{
+    mavlink_timesync_t packet;
+    packet.tc1 = 0;
+    packet.ts1 = MonotonicClock::now();
+    m_requestNs = packet.ts1;
+
+    mavlink_message_t message;
+    mavlink_msg_timesync_encode(C::SystemId, MAV_COMP_ID_SYSTEM_CONTROL,
+                                &message, &packet);
+    m_mavlinkInterface->sendMessage(message);
+}
+
+void ClockSync::handleTimesync(const MavlinkFrame &frame)
+{
+    mavlink_timesync_t packet;
+    frame.decode(&packet);
+
+    if (packet.tc1 == 0) {
+        // Request of the autopilot, answer with the host time
+        if (!m_timesyncEnabled) {
+            return;
+        }
+        packet.tc1 = MonotonicClock::now();
+        mavlink_message_t message;
+        mavlink_msg_timesync_encode(C::SystemId, MAV_COMP_ID_SYSTEM_CONTROL,
+                                    &message, &packet);
+        m_mavlinkInterface->sendMessage(message);
+        return;
+    }
+    // Answers to other systems' requests echo their times
+    if (packet.ts1 != m_requestNs || m_requestNs == 0) {
+        return;
+    }
+    m_requestNs = 0;
+
+    if (!m_timesyncAnswered) {
+        // Drop the less precise SYSTEM_TIME samples
+        m_timesyncAnswered = true;
+        reset();
+    }
+    if (packet.tc1 < m_lastRemoteNs) {
+        reset();
+    }
+    m_lastRemoteNs = packet.tc1;
+
+    Sample sample;
+    sample.roundTripNs = frame.rxTimeNs - packet.ts1;
+    sample.hostNs = packet.ts1 + sample.roundTripNs / 2;
+    sample.offsetNs = packet.tc1 - sample.hostNs;
+    if (sample.roundTripNs < 0 || sample.roundTripNs > MaxRoundTripNs) {
+        m_rejectedSamples++;
+        return;
+    }
+    addSample(sample);
+}
+
+void ClockSync::handleSystemTime(const MavlinkFrame &frame)
+{
+    if (m_timesyncAnswered) {
+        return;
+    }
+    mavlink_system_time_t packet;
+    frame.decode(&packet);
+
+    const qint64 remoteNs = static_cast<qint64>(packet.time_boot_ms) * 1000000;
+    if (remoteNs < m_lastRemoteNs) {
+        reset();
+    }
+    m_lastRemoteNs = remoteNs;
+
+    Sample sample;
+    sample.hostNs = frame.rxTimeNs;
+    sample.offsetNs = remoteNs - frame.rxTimeNs;
+    sample.roundTripNs = 0;
+    addSample(sample);
+}
+
+void ClockSync::addSample(const Sample &sample)
+{
+    if (m_synchronized && m_timesyncAnswered
+            && sample.roundTripNs <= 2 * m_roundTripNs + RoundTripMarginNs) {
+        const qint64 expectedNs = m_offsetNs + static_cast<qint64>(
+                    m_drift * (sample.hostNs - m_referenceNs));
+        if (qAbs(sample.offsetNs - expectedNs) > MaxResidualNs) {
+            m_rejectedSamples++;
+            if (++m_outliers < MaxOutliers) {
+                return;
+            }
+            qWarning().noquote() << tr("Warning: Autopilot clock jumped, synchronising again.");
+            reset();
+        }
+    }
+    m_outliers = 0;
+
+    m_samples[m_nextSample] = sample;
+    m_nextSample = (m_nextSample + 1) % WindowSize;
+    m_sampleCount = qMin(m_sampleCount + 1, WindowSize);
+    updateEstimate();
+}
+
+void ClockSync::updateEstimate()
+{
+    const bool wasSynchronized = m_synchronized;
+
+    if (!m_timesyncAnswered) {
+        // One-way samples: the least delayed one has the largest offset
+        qint64 offsetNs = m_samples[0].offsetNs;
+        for (int i = 1; i < m_sampleCount; ++i) {
+            offsetNs = qMax(offsetNs, m_samples[i].offsetNs);
+        }
+        m_offsetNs = offsetNs;
+        m_referenceNs = 0;
+        m_drift = 0;
+        m_roundTripNs = 0;
+        m_synchronized = true;
+    } else {
+        qint64 minRoundTripNs = MaxRoundTripNs;
+        for (int i = 0; i < m_sampleCount; ++i) {
+            minRoundTripNs = qMin(minRoundTripNs, m_samples[i].roundTripNs);
+        }
+        // Slow round trips are likely asymmetric
+        const qint64 limitNs = 2 * minRoundTripNs + RoundTripMarginNs;
+
+        // Least squares line relative to the newest sample for precision
+        const qint64 originNs = m_samples[(m_nextSample + WindowSize - 1) % WindowSize].hostNs;
+        const qint64 offsetOriginNs = m_samples[(m_nextSample + WindowSize - 1) % WindowSize].offsetNs;
+        int count = 0;
+        double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+        qint64 minHostNs = originNs;
+        for (int i = 0; i < m_sampleCount; ++i) {
+            const Sample &sample = m_samples[i];
+            if (sample.roundTripNs > limitNs) {
+                continue;
+            }
+            const double x = sample.hostNs - originNs;
+            const double y = sample.offsetNs - offsetOriginNs;
+            count++;
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumXY += x * y;
+            minHostNs = qMin(minHostNs, sample.hostNs);
+        }
+        const double meanX = sumX / count;
+        const double meanY = sumY / count;
+        double drift = 0;
+        if (originNs - minHostNs >= MinDriftSpanNs) {
+            drift = (sumXY - count * meanX * meanY) / (sumXX - count * meanX * meanX);
+            if (qAbs(drift) > MaxDrift) {
+                drift = 0;
+            }
+        }
+        m_referenceNs = originNs + static_cast<qint64>(meanX);
+        m_offsetNs = offsetOriginNs + static_cast<qint64>(meanY);
+        m_drift = drift;
+        m_roundTripNs = minRoundTripNs;
+        m_synchronized = true;
+    }
+
+    if (!wasSynchronized) {
+        qInfo().noquote() << tr("Autopilot clock synchronised from %1.")
+                             .arg(m_timesyncAnswered ? "TIMESYNC" : "SYSTEM_TIME");
+        if (m_timer.isActive()) {
+            m_timer.start(TimesyncInterval);
+        }
+    }
+}
+
+void ClockSync::reset()
+{
+    m_sampleCount = 0;
+    m_nextSample = 0;
+    m_outliers = 0;
+    m_lastRemoteNs = 0;
+    m_synchronized = false;
+    if (m_timer.isActive()) {
+        m_timer.start(FastTimesyncInterval);
+    }
+}
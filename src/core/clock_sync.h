@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file clock_sync.h
+ * @brief File contains a declaration of the autopilot clock synchronisation - ClockSync
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <QObject>
+#include <QTimer>
+
+#include "mavlink_interface.h"
+
+/**
+ * @brief Mapping of the autopilot clock to the host monotonic clock
+ *
+ * The autopilot clock (time since boot) is modelled as the host clock plus
+ * an offset which drifts linearly. Offset samples come from TIMESYNC
+ * exchanges: the host sends its time, the autopilot answers with its own
+ * one, and the autopilot time is taken to belong to the middle of the round
+ * trip. Samples whose round trip is much longer than the fastest recent one
+ * are asymmetric and rejected, the rest are fitted with a line to get the
+ * offset and the drift. A sample far off the fit is an outlier unless
+ * several in a row are, which means the autopilot clock jumped.
+ *
+ * Autopilots which don't answer TIMESYNC are synchronised from SYSTEM_TIME
+ * instead. Its one-way samples include the link delay, so the least
+ * delayed recent one gives the offset, without drift.
+ *
+ * ClockSync belongs to a MavlinkInterface and runs on its thread.
+ */
+class ClockSync : public QObject, public MavlinkConsumer
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Interval of TIMESYNC requests once synchronised (ms)
+     */
+    static const int TimesyncInterval = 1000;
+    /**
+     * @brief Interval of TIMESYNC requests while synchronising (ms)
+     */
+    static const int FastTimesyncInterval = 100;
+    /**
+     * @brief Number of recent offset samples the estimate is based on
+     */
+    static const int WindowSize = 32;
+    /**
+     * @brief Round trips longer than this are never used (ns)
+     */
+    static const qint64 MaxRoundTripNs = 200000000;
+    /**
+     * @brief Round trip tolerated over twice the fastest one (ns)
+     */
+    static const qint64 RoundTripMarginNs = 1000000;
+    /**
+     * @brief Distance from the fit beyond which a sample is an outlier (ns)
+     */
+    static const qint64 MaxResidualNs = 10000000;
+    /**
+     * @brief Outliers in a row after which the estimate restarts
+     */
+    static const int MaxOutliers = 3;
+    /**
+     * @brief Shortest sample time span to estimate the drift over (ns)
+     */
+    static const qint64 MinDriftSpanNs = 5000000000LL;
+
+    /**
+     * @brief Create the clock synchronisation of an interface
+     * @param mavlinkInterface interface to exchange TIMESYNC messages over
+     */
+    explicit ClockSync(MavlinkInterface *mavlinkInterface);
+
+    /**
+     * @brief Send TIMESYNC requests and answer the autopilot ones
+     *
+     * SYSTEM_TIME is used regardless.
+     *
+     * @param enabled true to use TIMESYNC
+     */
+    void setTimesyncEnabled(bool enabled) { m_timesyncEnabled = enabled; }
+
+    /**
+     * @brief Check whether the clock mapping is known
+     * @return true once an offset was estimated
+     */
+    bool isSynchronized() const { return m_synchronized; }
+    /**
+     * @brief Convert an autopilot time to host time
+     *
+     * Valid only if isSynchronized().
+     *
+     * @param remoteNs autopilot time since boot (ns)
+     * @return Host monotonic time (ns)
+     */
+    qint64 toHostTime(qint64 remoteNs) const;
+    /**
+     * @brief Get the fastest recent TIMESYNC round trip
+     * @return Round trip (ns), 0 if synchronised from SYSTEM_TIME
+     */
+    qint64 roundTripNs() const { return m_roundTripNs; }
+    /**
+     * @brief Get the number of rejected offset samples
+     * @return Rejected samples count
+     */
+    quint64 rejectedSamples() const { return m_rejectedSamples; }
+
+    /**
+     * @brief Handle TIMESYNC and SYSTEM_TIME frames
+     * @param frames frames to handle
+     * @param count number of frames
+     */
+    void handleFrames(const MavlinkFrame *frames, int count) Q_DECL_OVERRIDE;
+
+public slots:
+    /**
+     * @brief Start or stop the TIMESYNC exchange with the link state
+     */
+    void handleConnectionChanged();
+
+private slots:
+    /**
+     * @brief Send a TIMESYNC request
+     */
+    void sendRequest();
+
+private:
+    /**
+     * @brief Offset sample
+     */
+    struct Sample
+    {
+        /**
+         * @brief Host time of the sample (ns)
+         */
+        qint64 hostNs;
+        /**
+         * @brief Autopilot time minus host time (ns)
+         */
+        qint64 offsetNs;
+        /**
+         * @brief Round trip of the TIMESYNC exchange (ns)
+         */
+        qint64 roundTripNs;
+    };
+
+    /**
+     * @brief Handle a TIMESYNC message
+     * @param frame TIMESYNC frame
+     */
+    void handleTimesync(const MavlinkFrame &frame);
+    /**
+     * @brief Handle a SYSTEM_TIME message
+     * @param frame SYSTEM_TIME frame
+     */
+    void handleSystemTime(const MavlinkFrame &frame);
+    /**
+     * @brief Add an offset sample and update the estimate
+     * @param sample offset sample
+     */
+    void addSample(const Sample &sample);
+    /**
+     * @brief Fit the offset and drift to the recent samples
+     */
+    void updateEstimate();
+    /**
+     * @brief Forget all samples, e.g. after the autopilot rebooted
+     */
+    void reset();
+
+private:
+    /**
+     * @brief Interface to send TIMESYNC messages over
+     */
+    MavlinkInterface *m_mavlinkInterface;
+    /**
+     * @brief TIMESYNC request timer
+     */
+    QTimer m_timer;
+    /**
+     * @brief Whether TIMESYNC is used
+     */
+    bool m_timesyncEnabled = true;
+    /**
+     * @brief Whether the autopilot has answered a TIMESYNC request
+     */
+    bool m_timesyncAnswered = false;
+    /**
+     * @brief Host time of the last TIMESYNC request (ns)
+     */
+    qint64 m_requestNs = 0;
+    /**
+     * @brief Last autopilot time seen (ns), used to detect reboots
+     */
+    qint64 m_lastRemoteNs = 0;
+
+    /**
+     * @brief Recent samples, a ring of WindowSize entries
+     */
+    Sample m_samples[WindowSize];
+    /**
+     * @brief Number of samples in m_samples
+     */
+    int m_sampleCount = 0;
+    /**
+     * @brief Index the next sample is stored at
+     */
+    int m_nextSample = 0;
+    /**
+     * @brief Outliers in a row
+     */
+    int m_outliers = 0;
+    /**
+     * @brief Samples rejected for their round trip or as outliers
+     */
+    quint64 m_rejectedSamples = 0;
+
+    /**
+     * @brief Whether the estimate is valid
+     */
+    bool m_synchronized = false;
+    /**
+     * @brief Host time the offset is estimated at (ns)
+     */
+    qint64 m_referenceNs = 0;
+    /**
+     * @brief Offset at m_referenceNs (ns)
+     */
+    qint64 m_offsetNs = 0;
+    /**
+     * @brief Change of the offset per host nanosecond
+     */
+    double m_drift = 0;
+    /**
+     * @brief Fastest recent round trip (ns)
+     */
+    qint64 m_roundTripNs = 0;
+};
+
+#endif // #ifndef CLOCK_SYNC_H
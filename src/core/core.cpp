@@ -27,94 +27,203 @@
  */
  
 #include "core.h"
+#include "attitude_server.h"
+#include "clock_sync.h"
+#include "message_rates.h"
 #include "mavlink_interface.h"
+#include "monotonic_clock.h"
 
-#include <QNetworkProxy>
-#include <QNetworkRequest>
-#include <QNetworkReply>
-#include <QUrl>
 
 #include <QDebug>
 
-namespace C {
-const char * const ApiHost = "http://127.0.0.1:8123";
-const char * const ApiPath = "/api/v1";
-}
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
 
 const quint32 MAX_LOST_COUNTER = 5;
+const float DefaultAttitudeRate = 10;
+/**
+ * @brief Rate of SYSTEM_TIME, used by ClockSync if TIMESYNC isn't answered
+ */
+const float SystemTimeRate = 1;
+
+/**
+ * @brief MAVLink messages handled by Core
+ */
+const MavlinkMessageIds CoreMessageIds =
+        mavlinkMessageIds<MAVLINK_MSG_ID_HEARTBEAT,
+                          MAVLINK_MSG_ID_ATTITUDE,
+                          MAVLINK_MSG_ID_ATTITUDE_QUATERNION>();
 
 Core::Core(QObject *parent) :
-    QObject(parent), m_heartbitCounter(10), m_lostCounter(0)
+    QObject(parent), m_heartbitCounter(10), m_lostCounter(0),
+    m_drainScheduled(false), m_droppedSamples(0)
 {
-    m_mavlinkInterface = new MavlinkInterface(this);
-    connect(m_mavlinkInterface, &MavlinkInterface::hasMessage,
-            this, &Core::handleMessage);
+    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+
+    // No parent: the interface may be moved to the I/O thread
+    m_mavlinkInterface = new MavlinkInterface();
+    m_mavlinkInterface->subscribe(this, CoreMessageIds);
+    setAttitudeRate(DefaultAttitudeRate);
+    m_mavlinkInterface->messageRates()->setRate(MAVLINK_MSG_ID_SYSTEM_TIME, SystemTimeRate);
 
     connect(&m_lifeTimer, &QTimer::timeout,
             this, &Core::lost);
+    connect(&m_rateTimer, &QTimer::timeout,
+            this, &Core::adaptRate);
+    connect(&m_ioThread, &QThread::started, [this]() { pinIoThread(); });
 }
 
 Core::~Core()
 {
+    stop();
+    delete m_mavlinkInterface;
+    delete m_rateController;
 }
 
-void Core::handleMessage(const mavlink_message_t &msg)
+void Core::handleFrames(const MavlinkFrame *frames, int count)
 {
-    switch (msg.msgid) {
-    case MAVLINK_MSG_ID_HEARTBEAT: {
-#ifdef DEBUG
-        qDebug() << "HEARTBEAT";
-#endif
-        mavlink_heartbeat_t packet;
-        mavlink_msg_heartbeat_decode(&msg, &packet);
-        m_lostCounter = 0;
-        m_lifeTimer.start(3000);
-        if (!m_connected && (m_heartbitCounter == 0)) {
-            m_connected = true;
-            init();
-        } else if (m_heartbitCounter > 0) {
-            m_heartbitCounter--;
+    // Attitude messages are collected into a batch, so a read carrying
+    // several of them (replays, bursts after a stall) is converted at once
+    int batched = 0;
+    for (int i = 0; i < count; ++i) {
+        const MavlinkFrame &frame = frames[i];
+        if (frame.msgid() == MAVLINK_MSG_ID_HEARTBEAT) {
+            // Runs on the I/O thread if there is one
+            QMetaObject::invokeMethod(this, "handleHeartbeat", Qt::AutoConnection);
+        } else if (frame.msgid() == m_attitudeMessage) {
+            decodeAttitude(frame, batched);
+            if (++batched == AttitudeKernels::Batch::Capacity) {
+                publishBatch(batched);
+                batched = 0;
+            }
         }
-        break;
     }
-    case MAVLINK_MSG_ID_ATTITUDE: {
+    if (batched > 0) {
+        publishBatch(batched);
+    }
+}
+
+void Core::decodeAttitude(const MavlinkFrame &frame, int index)
+{
+    AttitudeSample &sample = m_batchSamples[index];
+    sample = AttitudeSample();
+    sample.rxTimeNs = frame.rxTimeNs;
+    if (m_attitudeMessage == MAVLINK_MSG_ID_ATTITUDE_QUATERNION) {
+        mavlink_attitude_quaternion_t packet;
+        frame.decode(&packet);
+        sample.timeBootMs = packet.time_boot_ms;
+        sample.rollspeed = packet.rollspeed;
+        sample.pitchspeed = packet.pitchspeed;
+        sample.yawspeed = packet.yawspeed;
+        m_batch.w[index] = packet.q1;
+        m_batch.x[index] = packet.q2;
+        m_batch.y[index] = packet.q3;
+        m_batch.z[index] = packet.q4;
+    } else {
         mavlink_attitude_t packet;
-        mavlink_msg_attitude_decode(&msg, &packet);
-        sendAngles(packet.roll, packet.pitch, packet.yaw);
+        frame.decode(&packet);
+        sample.timeBootMs = packet.time_boot_ms;
+        sample.rollspeed = packet.rollspeed;
+        sample.pitchspeed = packet.pitchspeed;
+        sample.yawspeed = packet.yawspeed;
+        m_batch.roll[index] = packet.roll;
+        m_batch.pitch[index] = packet.pitch;
+        m_batch.yaw[index] = packet.yaw;
+    }
+}
+
+void Core::publishBatch(int count)
+{
+    if (m_attitudeMessage == MAVLINK_MSG_ID_ATTITUDE_QUATERNION) {
+        AttitudeKernels::quaternionToEuler(&m_batch, count);
+    } else {
+        AttitudeKernels::eulerToQuaternion(&m_batch, count);
+    }
+
+    const ClockSync *clockSync = m_mavlinkInterface->clockSync();
+    for (int i = 0; i < count; ++i) {
+        AttitudeSample &sample = m_batchSamples[i];
+        sample.roll = m_batch.roll[i];
+        sample.pitch = m_batch.pitch[i];
+        sample.yaw = m_batch.yaw[i];
+        sample.latencyNs = m_linkLatency.update(sample.timeBootMs, sample.rxTimeNs);
+        if (clockSync->isSynchronized()) {
+            sample.timeNs = clockSync->toHostTime(
+                        static_cast<qint64>(sample.timeBootMs) * 1000000);
+            sample.latencyNs = sample.rxTimeNs - sample.timeNs;
+        }
+
+        Quaternion q;
+        q.w = m_batch.w[i];
+        q.x = m_batch.x[i];
+        q.y = m_batch.y[i];
+        q.z = m_batch.z[i];
+        m_history.append(sample, q);
+        if (!m_samples.push(sample)) {
+            m_droppedSamples++;
+        }
 #ifdef DEBUG
-        qDebug() << "MAVLINK_MSG_ID_ATTITUDE" <<
-                    "Roll:" << packet.roll <<
-                    "Pitch:" << packet.pitch <<
-                    "Yaw:" << packet.yaw;
+        qDebug() << "Attitude" <<
+                    "Roll:" << sample.roll <<
+                    "Pitch:" << sample.pitch <<
+                    "Yaw:" << sample.yaw;
 #endif
-        break;
     }
-    default:
+    if (!m_drainScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, "drainSamples", Qt::AutoConnection);
+    }
+}
+
+void Core::handleHeartbeat()
+{
 #ifdef DEBUG
-        static QSet<quint8> ids;
-        ids << msg.msgid;
-        QList<quint8> list = ids.toList();
-        qSort(list);
-        qDebug() << "IDs" << list;
+    qDebug() << "HEARTBEAT";
 #endif
-        break;
+    m_lostCounter = 0;
+    m_lifeTimer.start(3000);
+    if (!m_connected && (m_heartbitCounter == 0)) {
+        m_connected = true;
+        init();
+    } else if (m_heartbitCounter > 0) {
+        m_heartbitCounter--;
     }
 }
 
-void Core::handleReply()
+void Core::drainSamples()
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
-    Q_ASSERT(reply);
-    if (reply->error()) {
-        qWarning().noquote() << tr("Warning: HTTP request failed ('%1').")
-                                .arg(reply->request().url().toString());
+    // Clear the flag first, so samples pushed while draining schedule
+    // another drain
+    m_drainScheduled = false;
+    AttitudeSample sample;
+    while (m_samples.pop(sample)) {
+        m_receivedSamples++;
+        sendAngles(sample);
     }
-    reply->deleteLater();
 }
 
 void Core::init()
 {
-    requestDataStream(MAV_DATA_STREAM_EXTRA1, 10);
+    QMetaObject::invokeMethod(m_mavlinkInterface->messageRates(), "request",
+                              Qt::AutoConnection);
+}
+
+void Core::setAttitudeRate(float rate)
+{
+    m_attitudeRate = rate;
+    m_mavlinkInterface->messageRates()->setRate(m_attitudeMessage, rate,
+                                                MAV_DATA_STREAM_EXTRA1);
+}
+
+void Core::setQuaternionAttitude(bool enabled)
+{
+    m_mavlinkInterface->messageRates()->setRate(m_attitudeMessage, 0);
+    m_attitudeMessage = enabled ? MAVLINK_MSG_ID_ATTITUDE_QUATERNION
+                                : MAVLINK_MSG_ID_ATTITUDE;
+    setAttitudeRate(m_attitudeRate);
 }
 
 void Core::lost()
@@ -124,7 +233,12 @@ void Core::lost()
     if (m_lostCounter >= MAX_LOST_COUNTER) {
         qWarning().noquote() << tr("Warning: Serious connection loss. "
                                    "Trying to reconnect.");
-        bool reconnectResult = m_mavlinkInterface->tryAnotherSerialInterface();
+        bool reconnectResult = false;
+        QMetaObject::invokeMethod(m_mavlinkInterface, "tryAnotherSerialInterface",
+                                  m_ioThread.isRunning() ?
+                                      Qt::BlockingQueuedConnection :
+                                      Qt::DirectConnection,
+                                  Q_RETURN_ARG(bool, reconnectResult));
         m_connected = false;
         m_heartbitCounter = 10;
         qWarning().noquote() << tr("Warning: New interface is: ") <<  m_mavlinkInterface->usedSerialName();
@@ -135,58 +249,148 @@ void Core::lost()
     }
 }
 
-void Core::requestDataStream(MAV_DATA_STREAM stream, quint16 rate)
+void Core::adaptRate()
 {
-    mavlink_request_data_stream_t packet;
-    memset(&packet, 0, sizeof(packet));
-    packet.req_stream_id = stream;
-    packet.req_message_rate = rate;
-    packet.start_stop = 1; // start
+    const RateController::Measurement totals = rateTotals();
+    RateController::Measurement measurement;
+    measurement.intervalNs = totals.intervalNs - m_rateTotals.intervalNs;
+    measurement.samples = totals.samples - m_rateTotals.samples;
+    measurement.bytes = totals.bytes - m_rateTotals.bytes;
+    measurement.linkCapacity = totals.linkCapacity;
+    measurement.frames = totals.frames - m_rateTotals.frames;
+    measurement.lostFrames = totals.lostFrames - m_rateTotals.lostFrames;
+    measurement.droppedSamples = totals.droppedSamples - m_rateTotals.droppedSamples;
+    measurement.deliveryTimeNs = totals.deliveryTimeNs;
+    m_rateTotals = totals;
 
-    mavlink_message_t message;
-    mavlink_msg_request_data_stream_encode(C::SystemId,
-                                           MAV_COMP_ID_SYSTEM_CONTROL,
-                                           &message,
-                                           &packet);
+    const double previousRate = m_rateController->rate();
+    const double rate = m_rateController->update(measurement);
+    // Don't bother the autopilot with fractional changes
+    if (qRound(rate) == qRound(previousRate)) {
+        return;
+    }
+#ifdef DEBUG
+    qDebug() << "Attitude rate (Hz):" << qRound(rate);
+#endif
+    QMetaObject::invokeMethod(m_mavlinkInterface->messageRates(), "updateRate",
+                              Qt::AutoConnection,
+                              Q_ARG(int, m_attitudeMessage),
+                              Q_ARG(float, static_cast<float>(qRound(rate))));
+}
+
+RateController::Measurement Core::rateTotals() const
+{
+    RateController::Measurement totals;
+    totals.intervalNs = MonotonicClock::now();
+    totals.samples = m_receivedSamples;
+    totals.bytes = m_mavlinkInterface->receivedBytes();
+    totals.linkCapacity = m_mavlinkInterface->linkCapacity();
+    totals.frames = m_mavlinkInterface->receivedFrames();
+    totals.lostFrames = m_mavlinkInterface->lostFrames();
+    totals.droppedSamples = m_droppedSamples;
+    for (SinkChannel *channel : m_channels) {
+        totals.droppedSamples += channel->droppedSamples() + channel->sink()->droppedSamples();
+        totals.deliveryTimeNs = qMax(totals.deliveryTimeNs, channel->sink()->deliveryTimeNs());
+    }
+    return totals;
+}
 
-    m_mavlinkInterface->sendMessage(message);
+void Core::sendAngles(const AttitudeSample &sample) {
+#ifdef DEBUG
+    qDebug() << "Sample age (us):"
+             << (MonotonicClock::now() - sample.rxTimeNs) / 1000;
+#endif
+    for (SinkChannel *channel : m_channels) {
+        channel->push(sample);
+    }
 }
 
-void Core::sendAngles(float roll, float pitch, float yaw) {
-    qDebug() << QString("%1%2/attitude/%3,%4,%5")
-                .arg(C::ApiHost)
-                .arg(C::ApiPath)
-                .arg(roll)
-                .arg(pitch)
-                .arg(yaw);
-    QUrl requestUrl(QString("%1%2/attitude/%3,%4,%5")
-                    .arg(C::ApiHost)
-                    .arg(C::ApiPath)
-                    .arg(roll)
-                    .arg(pitch)
-                    .arg(yaw));
-    QNetworkReply *reply =
-            m_net.post(QNetworkRequest(requestUrl), QByteArray());
-    connect(reply, &QNetworkReply::finished, this, &Core::handleReply);
+void Core::addSink(AttitudeSink *sink, const SinkPolicy &policy)
+{
+    if (AttitudeServer *server = qobject_cast<AttitudeServer *>(sink)) {
+        server->setHistory(&m_history);
+    }
+    m_channels.append(new SinkChannel(sink, policy, this));
 }
 
 bool Core::start()
 {
-    QNetworkProxy proxy;
-    proxy.setType(QNetworkProxy::NoProxy);
-    m_net.setProxy(proxy);
+    for (SinkChannel *channel : m_channels) {
+        if (!channel->sink()->open()) {
+            qCritical().noquote() << tr("Error: Failed to open attitude output.");
+            return false;
+        }
+    }
+
+    Qt::ConnectionType connection = Qt::DirectConnection;
+    if (m_ioThreadEnabled) {
+        m_mavlinkInterface->moveToThread(&m_ioThread);
+        m_ioThread.start();
+        connection = Qt::BlockingQueuedConnection;
+    }
 
-    if (!m_mavlinkInterface->open()) {
+    bool opened = false;
+    QMetaObject::invokeMethod(m_mavlinkInterface, "open", connection,
+                              Q_RETURN_ARG(bool, opened));
+    if (!opened) {
         qCritical().noquote() << tr("Error: Failed to open MAVLink device.");
         return false;
     }
-    m_mavlinkInterface->clear();
+    QMetaObject::invokeMethod(m_mavlinkInterface, "clear", connection);
     m_lifeTimer.start(6000);
+
+    if (m_maxAttitudeRate > 0) {
+        delete m_rateController;
+        m_rateController = new RateController(m_attitudeRate, m_maxAttitudeRate);
+        m_rateTotals = rateTotals();
+        m_rateTimer.start(RateController::Interval);
+    }
     return true;
 }
 
 
 void Core::stop()
 {
-    m_mavlinkInterface->close();
+    m_rateTimer.stop();
+    for (SinkChannel *channel : m_channels) {
+        channel->sink()->close();
+        channel->reset();
+    }
+    if (m_ioThread.isRunning()) {
+        QMetaObject::invokeMethod(m_mavlinkInterface, "close",
+                                  Qt::BlockingQueuedConnection);
+        m_ioThread.quit();
+        m_ioThread.wait();
+    } else {
+        m_mavlinkInterface->close();
+    }
+}
+
+void Core::setIoThread(bool enabled, int cpu)
+{
+    m_ioThreadEnabled = enabled;
+    m_ioCpu = cpu;
+}
+
+void Core::pinIoThread()
+{
+    if (m_ioCpu < 0) {
+        return;
+    }
+#ifdef Q_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(m_ioCpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        qWarning().noquote() << tr("Warning: Failed to pin I/O thread to CPU %1.")
+                                .arg(m_ioCpu);
+    }
+#elif defined(Q_OS_WIN)
+    if (!SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << m_ioCpu)) {
+        qWarning().noquote() << tr("Warning: Failed to pin I/O thread to CPU %1.")
+                                .arg(m_ioCpu);
+    }
+#else
+    qWarning().noquote() << tr("Warning: I/O thread pinning is not supported.");
+#endif
 }
@@ -36,12 +36,23 @@
 
 #include <QObject>
 
-#include <QNetworkAccessManager>
+#include <QList>
+#include <QThread>
 #include <QTimer>
 
+#include <atomic>
+
 #include <common/mavlink.h>
 
-class MavlinkInterface;
+#include "attitude_history.h"
+#include "attitude_kernels.h"
+#include "attitude_predictor.h"
+#include "attitude_sample.h"
+#include "attitude_sink.h"
+#include "sink_channel.h"
+#include "mavlink_interface.h"
+#include "rate_controller.h"
+#include "spsc_queue.h"
 
 /**
  * @brief A core application class to interface betveen MAVLink and server
@@ -50,9 +61,15 @@ class MavlinkInterface;
  * receives data from an IMU device, dispatches useful messages and transmits
  * them to a server.
  *
+ * The MAVLink interface may run on a dedicated I/O thread. Attitude samples
+ * are then passed to the output stage through a lock-free queue, so a slow
+ * HTTP server never delays reading the MAVLink device. The output stage
+ * fans every sample out to the attitude sinks, each through a SinkChannel
+ * applying its rate, decimation and queueing policy.
+ *
  * @see MavlinkInterface
  */
-class Core : public QObject
+class Core : public QObject, public MavlinkConsumer
 {
     Q_OBJECT
 public:
@@ -75,6 +92,27 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Read and parse MAVLink data on a dedicated thread
+     *
+     * Must be called before start().
+     *
+     * @param enabled true to use an I/O thread
+     * @param cpu CPU core to pin the I/O thread to, -1 to not pin it
+     */
+    void setIoThread(bool enabled, int cpu = -1);
+
+    /**
+     * @brief Add an attitude output
+     *
+     * Core takes ownership of the sink. An AttitudeServer answers lookups
+     * from history(). Must be called before start().
+     *
+     * @param sink attitude sink
+     * @param policy output rate, decimation and queueing policy
+     */
+    void addSink(AttitudeSink *sink, const SinkPolicy &policy = SinkPolicy());
+
     /**
      * @brief Getter for the MAVLink interface used by Core
      * @return main MAVLink interface
@@ -82,48 +120,119 @@ public:
     MavlinkInterface *mavlinkInterface() const { return m_mavlinkInterface; }
 
     /**
-     * @brief Send MAVLink packet to request a specific data stream
-     * @param stream MAVLink data stream to use
-     * @param rate requested message rate
+     * @brief Getter for the recent attitude samples
+     *
+     * Samples are appended on the MAVLink I/O thread, the history may be
+     * read from any thread.
+     *
+     * @return Attitude history
+     */
+    const AttitudeHistory &history() const { return m_history; }
+
+    /**
+     * @brief Set the rate attitude messages are requested at
+     *
+     * Must be called before start().
+     *
+     * @param rate rate (Hz)
+     */
+    void setAttitudeRate(float rate);
+    /**
+     * @brief Take the attitude from ATTITUDE_QUATERNION messages
+     *
+     * ATTITUDE_QUATERNION is requested instead of ATTITUDE and ATTITUDE
+     * messages are ignored. The euler angles of the samples are converted
+     * from the quaternions, the attitude history keeps the quaternions as
+     * received. Must be called before start().
+     *
+     * @param enabled true to use ATTITUDE_QUATERNION, false for ATTITUDE
+     */
+    void setQuaternionAttitude(bool enabled);
+    /**
+     * @brief Adapt the attitude rate to the link and output load
+     *
+     * The rate starts at the one set with setAttitudeRate(). Must be called
+     * before start().
+     *
+     * @param maxRate highest rate (Hz), 0 to keep the rate fixed
+     * @see RateController
      */
-    void requestDataStream(MAV_DATA_STREAM stream, quint16 rate);
+    void setAdaptiveRate(double maxRate) { m_maxAttitudeRate = maxRate; }
 
-public slots:
     /**
-     * @brief Handle incoming MAVLink message from the interface
+     * @brief Handle a batch of MAVLink frames from the interface
      *
-     * Handles incoming MAVLink messages. Only HEARTBIT and ATTITUDE messages
-     * are really handled. All other messages are being just passed by.
+     * Core is subscribed to HEARTBIT, ATTITUDE and ATTITUDE_QUATERNION
+     * messages only. Attitude messages of a batch are converted together,
+     * see AttitudeKernels.
      *
-     * @param msg MAVLink message to handle
+     * @param frames MAVLink frames to handle
+     * @param count number of frames
      */
-    void handleMessage(const mavlink_message_t &msg);
+    void handleFrames(const MavlinkFrame *frames, int count) Q_DECL_OVERRIDE;
 
 private slots:
+    /**
+     * @brief Handle HEARTBIT message
+     */
+    void handleHeartbeat();
+
+    /**
+     * @brief Send attitude samples queued by the MAVLink interface
+     */
+    void drainSamples();
+
     /**
      * @brief Handle timer event if HEARTBITs don't come for too long
      */
     void lost();
 
     /**
-     * @brief Handle HTTP reply
+     * @brief Update the adaptive attitude rate
      */
-    void handleReply();
+    void adaptRate();
 
 private:
 
     /**
-     * @brief Initalize the MAVLink data stream as a MAV_DATA_STREAM_EXTRA1
+     * @brief Decode an attitude message into m_batch
+     * @param frame ATTITUDE or ATTITUDE_QUATERNION frame
+     * @param index position in the batch
+     */
+    void decodeAttitude(const MavlinkFrame &frame, int index);
+
+    /**
+     * @brief Convert the angles of m_batch and pass its samples to outputs
+     * @param count number of samples in the batch
+     */
+    void publishBatch(int count);
+
+    /**
+     * @brief Pin the calling thread to m_ioCpu
+     */
+    void pinIoThread();
+
+    /**
+     * @brief Request the MAVLink messages Core needs
+     *
+     * Called whenever the autopilot appears, so the rates are restored after
+     * it was lost or rebooted.
+     *
+     * @see MessageRates
      */
     void init();
 
     /**
-     * @brief Send gyroscope angles to the server by HTTP
-     * @param roll gyroscope roll (rad)
-     * @param pitch gyroscope pitch (rad)
-     * @param yaw gyroscope yaw (rad)
+     * @brief Get the totals the adaptive rate is measured from
+     * @return Totals, with intervalNs holding the current time
+     */
+    RateController::Measurement rateTotals() const;
+
+    /**
+     * @brief Send gyroscope angles to all attitude outputs
+     * @param sample attitude sample with angles in radians
      */
-    void sendAngles(float roll, float pitch, float yaw);
+    void sendAngles(const AttitudeSample &sample);
 
     /**
      * @brief Send gyroscope roll to the server
@@ -178,9 +287,81 @@ private:
     QTimer m_lifeTimer;
 
     /**
-     * @brief Network access manager to interface with an HTTP server
+     * @brief Fan-out stages of the attitude outputs, owned by Core
+     */
+    QList<SinkChannel *> m_channels;
+
+    /**
+     * @brief MAVLink message the attitude is taken from
+     */
+    quint8 m_attitudeMessage = MAVLINK_MSG_ID_ATTITUDE;
+    /**
+     * @brief Requested attitude rate (Hz)
+     */
+    float m_attitudeRate = 0;
+    /**
+     * @brief Highest adaptive attitude rate (Hz), 0 for a fixed rate
+     */
+    double m_maxAttitudeRate = 0;
+    /**
+     * @brief Adaptive attitude rate, Q_NULLPTR for a fixed rate
+     */
+    RateController *m_rateController = Q_NULLPTR;
+    /**
+     * @brief Timer of adaptive rate updates
+     */
+    QTimer m_rateTimer;
+    /**
+     * @brief Totals at the previous adaptive rate update
+     */
+    RateController::Measurement m_rateTotals;
+    /**
+     * @brief Attitude samples passed to the outputs
+     */
+    quint64 m_receivedSamples = 0;
+
+    /**
+     * @brief Whether the MAVLink interface runs on m_ioThread
+     */
+    bool m_ioThreadEnabled = false;
+    /**
+     * @brief CPU core the I/O thread is pinned to, -1 if not pinned
+     */
+    int m_ioCpu = -1;
+    /**
+     * @brief Thread reading and parsing MAVLink data
+     */
+    QThread m_ioThread;
+
+    /**
+     * @brief Link delay estimation of attitude samples, used on the I/O thread
+     */
+    LinkLatencyEstimator m_linkLatency;
+    /**
+     * @brief Attitude messages of a frame batch being converted, used on the
+     *        I/O thread
+     */
+    AttitudeKernels::Batch m_batch;
+    /**
+     * @brief Samples of m_batch, without angles until they are converted
+     */
+    AttitudeSample m_batchSamples[AttitudeKernels::Batch::Capacity];
+    /**
+     * @brief Recent attitude samples, appended as they are received
+     */
+    AttitudeHistory m_history;
+    /**
+     * @brief Attitude samples passed from the MAVLink interface to outputs
+     */
+    SpscQueue<AttitudeSample, 256> m_samples;
+    /**
+     * @brief Whether drainSamples() is already scheduled
+     */
+    std::atomic<bool> m_drainScheduled;
+    /**
+     * @brief Samples dropped because the output stage was too slow
      */
-    QNetworkAccessManager m_net;
+    std::atomic<quint64> m_droppedSamples;
 };
 
 #endif // #ifndef CORE_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "fast_format.h"
+
+#include <math.h>
+
+namespace {
+const int MaxDigits = 20;
+const qint64 Powers[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+char *appendUnsigned(char *out, quint64 value)
+{
+    char digits[MaxDigits];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+}
+
+char *FastFormat::appendInt(char *out, qint64 value)
+{
+    if (value < 0) {
+        *out++ = '-';
+        return appendUnsigned(out, 0 - static_cast<quint64>(value));
+    }
+    return appendUnsigned(out, static_cast<quint64>(value));
+}
+
+char *FastFormat::appendFixed(char *out, double value, int decimals)
+{
+    if (isnan(value)) {
+        memcpy(out, "nan", 3);
+        return out + 3;
+    }
+    if (isinf(value)) {
+        if (value < 0) {
+            *out++ = '-';
+        }
+        memcpy(out, "inf", 3);
+        return out + 3;
+    }
+
+    decimals = qBound(0, decimals, 9);
+    const qint64 scale = Powers[decimals];
+    const double limit = 9.2e18;
+    double scaled = fabs(value) * scale + 0.5;
+    if (scaled > limit) {
+        scaled = limit;
+    }
+    quint64 fixed = static_cast<quint64>(scaled);
+
+    // Drop trailing zeros of the fraction
+    while (decimals > 0 && fixed % 10 == 0) {
+        fixed /= 10;
+        decimals--;
+    }
+    const quint64 divisor = static_cast<quint64>(Powers[decimals]);
+
+    if (value < 0 && fixed != 0) {
+        *out++ = '-';
+    }
+    out = appendUnsigned(out, fixed / divisor);
+    if (decimals > 0) {
+        *out++ = '.';
+        quint64 fraction = fixed % divisor;
+        for (int i = decimals - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file fast_format.h
+ * @brief File contains allocation-free number formatting helpers
+ */
+
+#ifndef FAST_FORMAT_H
+#define FAST_FORMAT_H
+
+#include <QtGlobal>
+
+#include <string.h>
+
+/**
+ * @brief Allocation-free number formatting into caller-owned buffers
+ *
+ * Used on output paths which format every attitude sample, where
+ * QString::arg() and snprintf() are too slow.
+ */
+namespace FastFormat {
+
+/**
+ * @brief Maximal number of characters written by appendInt()
+ */
+const int MaxIntLength = 20;
+/**
+ * @brief Maximal number of characters written by appendFixed()
+ */
+const int MaxFixedLength = 32;
+
+/**
+ * @brief Write a decimal integer
+ * @param out buffer with room for MaxIntLength characters
+ * @param value value to write
+ * @return Pointer past the last written character
+ */
+char *appendInt(char *out, qint64 value);
+
+/**
+ * @brief Write a number in fixed-point notation
+ *
+ * Trailing zeros of the fraction are dropped ("0.5", "-1.570796", "3").
+ * Non-finite values are written as "nan", "inf" or "-inf". Values which
+ * don't fit into 64 bits after scaling are clamped.
+ *
+ * @param out buffer with room for MaxFixedLength characters
+ * @param value value to write
+ * @param decimals number of fraction digits, at most 9
+ * @return Pointer past the last written character
+ */
+char *appendFixed(char *out, double value, int decimals = 6);
+
+/**
+ * @brief Write a string literal without its terminator
+ * @param out buffer with room for the literal
+ * @param text string literal
+ * @return Pointer past the last written character
+ */
+template<size_t N>
+inline char *appendLiteral(char *out, const char (&text)[N])
+{
+    memcpy(out, text, N - 1);
+    return out + N - 1;
+}
+
+} // namespace FastFormat
+
+#endif // #ifndef FAST_FORMAT_H
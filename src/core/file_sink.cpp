@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "file_sink.h"
+#include "monotonic_clock.h"
+
+#include <QDebug>
+
+FileSink::FileSink(QObject *parent) :
+    AttitudeSink(parent), m_file(this), m_flushTimer(this)
+{
+    m_flushTimer.setInterval(FlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout,
+            this, &FileSink::flush);
+}
+
+FileSink::~FileSink()
+{
+    close();
+}
+
+bool FileSink::open()
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning().noquote() << tr("Warning: Failed to open '%1' (%2).")
+                                .arg(m_file.fileName())
+                                .arg(m_file.errorString());
+        return false;
+    }
+    if (m_file.size() == 0) {
+        m_file.write("time_us,time_boot_ms,roll,pitch,yaw,"
+                     "rollspeed,pitchspeed,yawspeed\n");
+    }
+    m_errorReported = false;
+    m_flushTimer.start();
+    return true;
+}
+
+void FileSink::close()
+{
+    m_flushTimer.stop();
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+}
+
+void FileSink::write(const AttitudeSample &sample)
+{
+    char *out = m_line;
+    out = FastFormat::appendInt(out, (sample.rxTimeNs + MonotonicClock::systemOffset()) / 1000);
+    *out++ = ',';
+    out = FastFormat::appendInt(out, sample.timeBootMs);
+    const float values[] = {
+        sample.roll, sample.pitch, sample.yaw,
+        sample.rollspeed, sample.pitchspeed, sample.yawspeed
+    };
+    for (float value : values) {
+        *out++ = ',';
+        out = FastFormat::appendFixed(out, value);
+    }
+    *out++ = '\n';
+    if (m_file.write(m_line, out - m_line) < 0) {
+        reportError();
+    }
+}
+
+void FileSink::flush()
+{
+    if (!m_file.flush()) {
+        reportError();
+    }
+}
+
+void FileSink::reportError()
+{
+    if (m_errorReported) {
+        return;
+    }
+    m_errorReported = true;
+    qWarning().noquote() << tr("Warning: Failed to write '%1' (%2).")
+                            .arg(m_file.fileName())
+                            .arg(m_file.errorString());
+}
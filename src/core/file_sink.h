@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file file_sink.h
+ * @brief File contains a declaration of the CSV file attitude output - FileSink
+ */
+
+#ifndef FILE_SINK_H
+#define FILE_SINK_H
+
+#include <QFile>
+#include <QTimer>
+
+#include "attitude_sink.h"
+#include "fast_format.h"
+
+/**
+ * @brief Attitude output appending samples to a CSV file
+ *
+ * Every sample is one line:
+ * time_us,time_boot_ms,roll,pitch,yaw,rollspeed,pitchspeed,yawspeed
+ * where time_us is the host receive time (us since the epoch). Lines are
+ * formatted into a fixed buffer and written through the QFile buffer, which
+ * is flushed every FlushInterval, so readers tailing the file lag and a
+ * crash loses at most that much. The first write error is reported.
+ */
+class FileSink : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Interval of flushing the written lines to the file (ms)
+     */
+    static const int FlushInterval = 200;
+
+    FileSink(QObject *parent = Q_NULLPTR);
+    virtual ~FileSink();
+
+    /**
+     * @brief Set the file name
+     * @param fileName path of the CSV file
+     */
+    void setFileName(const QString &fileName) { m_file.setFileName(fileName); }
+
+    /**
+     * @brief Open the file for appending
+     * @return true on success, false otherwise
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Flush and close the file
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Append a sample
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+
+private slots:
+    /**
+     * @brief Write the buffered lines to the file
+     */
+    void flush();
+
+private:
+    /**
+     * @brief Warn about a failed write, once until the file is reopened
+     */
+    void reportError();
+
+private:
+    /**
+     * @brief Output file
+     */
+    QFile m_file;
+    /**
+     * @brief Timer flushing the file buffer
+     */
+    QTimer m_flushTimer;
+    /**
+     * @brief Whether a write error was reported
+     */
+    bool m_errorReported = false;
+    /**
+     * @brief Line buffer, big enough for any line
+     */
+    char m_line[2 * FastFormat::MaxIntLength + 6 * FastFormat::MaxFixedLength + 8];
+};
+
+#endif // #ifndef FILE_SINK_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "http2_sink.h"
+#include "fast_format.h"
+#include "http_sink.h"
+
+#include <QNetworkProxy>
+
+#include <QDebug>
+
+Http2Sink::Http2Sink(QObject *parent) :
+    AttitudeSink(parent), m_url(QString("%1%2").arg(C::ApiHost).arg(C::ApiPath)), m_net(this)
+{
+    m_net.setProxy(QNetworkProxy::NoProxy);
+}
+
+bool Http2Sink::open()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    if (m_url.scheme() != QLatin1String("http") || m_url.host().isEmpty()) {
+        qWarning().noquote() << tr("Warning: Unsupported HTTP/2 sink URL '%1', "
+                                   "only cleartext 'http' is supported.")
+                                .arg(m_url.toString());
+        return false;
+    }
+
+    m_request.setAttribute(QNetworkRequest::Http2DirectAttribute, true);
+    m_request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    m_request.setHeader(QNetworkRequest::ContentLengthHeader, 0);
+
+    QByteArray head = m_url.toEncoded();
+    while (head.endsWith('/')) {
+        head.chop(1);
+    }
+    head += "/attitude/";
+    m_requestUrl.resize(head.size() + 3 * FastFormat::MaxFixedLength + 2);
+    memcpy(m_requestUrl.data(), head.constData(), head.size());
+    m_requestUrlHeadSize = head.size();
+
+    m_open = true;
+    return true;
+#else
+    qWarning().noquote() << tr("Warning: HTTP/2 output requires Qt 5.11 or newer.");
+    return false;
+#endif
+}
+
+void Http2Sink::close()
+{
+    m_open = false;
+    for (QNetworkReply *reply : m_net.findChildren<QNetworkReply *>()) {
+        reply->abort();
+    }
+    m_pendingRequests = 0;
+}
+
+void Http2Sink::write(const AttitudeSample &sample)
+{
+    if (!m_open) {
+        return;
+    }
+    char *out = m_requestUrl.data() + m_requestUrlHeadSize;
+    out = FastFormat::appendFixed(out, sample.roll);
+    *out++ = ',';
+    out = FastFormat::appendFixed(out, sample.pitch);
+    *out++ = ',';
+    out = FastFormat::appendFixed(out, sample.yaw);
+
+    m_request.setUrl(QUrl::fromEncoded(QByteArray::fromRawData(
+            m_requestUrl.data(), static_cast<int>(out - m_requestUrl.data()))));
+    QNetworkReply *reply = m_net.post(m_request, QByteArray());
+    connect(reply, &QNetworkReply::finished, this, &Http2Sink::handleReply);
+    m_pendingRequests++;
+}
+
+void Http2Sink::handleReply()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    Q_ASSERT(reply);
+    reply->deleteLater();
+    if (!m_open) {
+        return;
+    }
+    m_pendingRequests--;
+    if (reply->error()) {
+        m_failedRequests++;
+        qWarning().noquote() << tr("Warning: HTTP/2 request failed ('%1').")
+                                .arg(reply->errorString());
+    }
+    if (!isBusy()) {
+        emit ready();
+    }
+}
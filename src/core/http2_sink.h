@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file http2_sink.h
+ * @brief File contains a declaration of the HTTP/2 attitude output - Http2Sink
+ */
+
+#ifndef HTTP2_SINK_H
+#define HTTP2_SINK_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+
+#include <vector>
+
+#include "attitude_sink.h"
+
+/**
+ * @brief Attitude output posting samples to the Camera Adapter over HTTP/2
+ *
+ * Uses the same REST contract as HttpSink ("POST <path>/attitude/<roll>,
+ * <pitch>,<yaw>"), but speaks cleartext HTTP/2 with prior knowledge (h2c),
+ * so all requests are multiplexed as streams of one connection with HPACK
+ * compressed headers and no head-of-line blocking between them.
+ *
+ * Requires Qt 5.11 or newer (QNetworkRequest::Http2DirectAttribute).
+ */
+class Http2Sink : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Default limit of concurrent streams
+     */
+    static const int DefaultMaxInFlight = 100;
+
+    Http2Sink(QObject *parent = Q_NULLPTR);
+
+    /**
+     * @brief Set the API base URL
+     * @param url API base URL, "http://127.0.0.1:8123/api/v1" by default
+     */
+    void setUrl(const QUrl &url) { m_url = url; }
+    /**
+     * @brief Get the API base URL
+     * @return API base URL
+     */
+    QUrl url() const { return m_url; }
+
+    /**
+     * @brief Limit the number of concurrent requests
+     * @param count maximal number of requests in flight, 0 for the default
+     */
+    void setMaxInFlight(int count) { m_maxInFlight = count > 0 ? count : DefaultMaxInFlight; }
+
+    /**
+     * @brief Prepare the request buffer
+     * @return true on success, false if HTTP/2 or the URL is not supported
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Abort pending requests
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Post an attitude sample
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+    /**
+     * @brief Check if the concurrent request limit is reached
+     * @return true if no request may be started now
+     */
+    bool isBusy() const Q_DECL_OVERRIDE { return m_pendingRequests >= m_maxInFlight; }
+
+    /**
+     * @brief Get the number of failed requests
+     * @return Failed requests count
+     */
+    quint64 failedRequests() const { return m_failedRequests; }
+
+private slots:
+    /**
+     * @brief Handle a finished request
+     */
+    void handleReply();
+
+private:
+    /**
+     * @brief API base URL
+     */
+    QUrl m_url;
+    /**
+     * @brief Network access manager owning the HTTP/2 connection
+     */
+    QNetworkAccessManager m_net;
+    /**
+     * @brief Request template with HTTP/2 enabled
+     */
+    QNetworkRequest m_request;
+    /**
+     * @brief Whether the sink is open
+     */
+    bool m_open = false;
+
+    /**
+     * @brief Encoded request URL buffer, starts with the URL prefix
+     */
+    std::vector<char> m_requestUrl;
+    /**
+     * @brief Size of the URL prefix in m_requestUrl
+     */
+    int m_requestUrlHeadSize = 0;
+
+    /**
+     * @brief Maximal number of requests in flight
+     */
+    int m_maxInFlight = DefaultMaxInFlight;
+    /**
+     * @brief Requests in flight
+     */
+    int m_pendingRequests = 0;
+    /**
+     * @brief Failed requests
+     */
+    quint64 m_failedRequests = 0;
+};
+
+#endif // #ifndef HTTP2_SINK_H
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "http_sink.h"
+#include "attitude_json.h"
+#include "fast_format.h"
+#include "monotonic_clock.h"
+
+#include <QNetworkProxy>
+
+#include <QDebug>
+
+#include <string.h>
+
+namespace {
+/**
+ * @brief Check if a header line starts with a header name
+ * @param line header line
+ * @param size size of @p line
+ * @param name lower case header name with the colon
+ * @return Pointer to the header value, Q_NULLPTR if the name doesn't match
+ */
+const char *headerValue(const char *line, int size, const char *name)
+{
+    const int nameSize = static_cast<int>(strlen(name));
+    if (size < nameSize || qstrnicmp(line, name, nameSize) != 0) {
+        return Q_NULLPTR;
+    }
+    const char *value = line + nameSize;
+    while (value < line + size && (*value == ' ' || *value == '\t')) {
+        value++;
+    }
+    return value;
+}
+}
+
+HttpSink::HttpSink(QObject *parent) :
+    AttitudeSink(parent), m_url(QString("%1%2").arg(C::ApiHost).arg(C::ApiPath)),
+    m_socket(this), m_reconnectTimer(this), m_batchTimer(this), m_statisticsTimer(this)
+{
+    m_socket.setProxy(QNetworkProxy::NoProxy);
+    m_reconnectTimer.setSingleShot(true);
+    m_reconnectTimer.setInterval(ReconnectInterval);
+    m_batchTimer.setSingleShot(true);
+    m_statisticsTimer.setInterval(StatisticsInterval);
+
+    connect(&m_socket, &QTcpSocket::connected,
+            this, &HttpSink::handleConnected);
+    connect(&m_socket, &QTcpSocket::readyRead,
+            this, &HttpSink::handleReadyRead);
+    // Covers both a closed connection and a failed connection attempt
+    connect(&m_socket, &QTcpSocket::stateChanged,
+            this, &HttpSink::handleStateChanged);
+    connect(&m_reconnectTimer, &QTimer::timeout,
+            this, &HttpSink::connectToServer);
+    connect(&m_batchTimer, &QTimer::timeout,
+            this, &HttpSink::flushBatch);
+    connect(&m_statisticsTimer, &QTimer::timeout,
+            this, &HttpSink::reportStatistics);
+}
+
+void HttpSink::setBatch(int size, int interval)
+{
+    m_batchSize = qMax(0, size);
+    m_batchInterval = qMax(0, interval);
+}
+
+HttpSink::~HttpSink()
+{
+    close();
+}
+
+bool HttpSink::open()
+{
+    if (m_url.scheme() != QLatin1String("http") || m_url.host().isEmpty()) {
+        qWarning().noquote() << tr("Warning: Unsupported HTTP sink URL '%1'.")
+                                .arg(m_url.toString());
+        return false;
+    }
+
+    QByteArray path = m_url.path(QUrl::FullyEncoded).toLatin1();
+    while (path.endsWith('/')) {
+        path.chop(1);
+    }
+    const QByteArray head = "POST " + path + "/attitude/";
+    m_requestTail = " HTTP/1.1\r\nHost: " + m_url.host(QUrl::FullyEncoded).toLatin1()
+            + ':' + QByteArray::number(m_url.port(80))
+            + "\r\nContent-Length: 0\r\n\r\n";
+
+    // Three angles with separators
+    const int anglesSize = 3 * FastFormat::MaxFixedLength + 2;
+    m_request.resize(head.size() + anglesSize + m_requestTail.size());
+    memcpy(m_request.data(), head.constData(), head.size());
+    m_requestHeadSize = head.size();
+
+    m_batchHead = "POST " + path + "/attitude HTTP/1.1\r\nHost: "
+            + m_url.host(QUrl::FullyEncoded).toLatin1()
+            + ':' + QByteArray::number(m_url.port(80))
+            + "\r\nContent-Type: application/json\r\nContent-Length: ";
+    m_batchTimer.setInterval(m_batchInterval > 0 ? m_batchInterval : DefaultBatchInterval);
+    if (isBatching()) {
+        const int batchSamples = m_batchSize > 1 ? qMin(m_batchSize, int(MaxBatchSamples))
+                                                 : MaxBatchSamples;
+        m_batchBody.reserve(batchSamples * (AttitudeJson::MaxLength + 1));
+        m_batchRequest.reserve(m_batchHead.size() + m_batchBody.capacity() + 32);
+    }
+
+    m_open = true;
+    m_statisticsTimer.start();
+    connectToServer();
+    return true;
+}
+
+void HttpSink::close()
+{
+    if (m_open) {
+        reportStatistics();
+    }
+    m_statisticsTimer.stop();
+    const bool sendLastBatch = m_open && m_batchCount > 0
+            && m_socket.state() == QAbstractSocket::ConnectedState;
+    if (sendLastBatch) {
+        sendBatch();
+    }
+    dropBatch();
+    m_open = false;
+    m_reconnectTimer.stop();
+    // Responses aren't awaited any more
+    m_pendingRequests = 0;
+    if (sendLastBatch) {
+        // Last batch, best effort: disconnectFromHost() writes pending data
+        // before closing, abort() would discard it
+        m_socket.disconnectFromHost();
+        if (m_socket.state() != QAbstractSocket::UnconnectedState
+                && !m_socket.waitForDisconnected(CloseTimeout)) {
+            qWarning().noquote() << tr("Warning: Last HTTP batch to '%1' may be lost.")
+                                    .arg(m_url.toString());
+        }
+    }
+    m_socket.abort();
+    m_responseSize = 0;
+    m_bodyLeft = 0;
+    m_hasHeldSample = false;
+}
+
+void HttpSink::write(const AttitudeSample &sample)
+{
+    if (m_socket.state() != QAbstractSocket::ConnectedState) {
+        m_droppedSamples++;
+        return;
+    }
+    if (isBatching()) {
+        if (m_batchCount >= MaxBatchSamples) {
+            m_droppedSamples++;
+            return;
+        }
+        char object[AttitudeJson::MaxLength + 1];
+        char *out = object;
+        if (m_batchCount > 0) {
+            *out++ = ',';
+        }
+        out = AttitudeJson::append(out, sample, ++m_seq);
+        m_batchBody.append(object, static_cast<int>(out - object));
+        if (++m_batchCount == 1) {
+            m_batchTimer.start();
+        }
+        if (m_batchSize > 1 && m_batchCount >= m_batchSize) {
+            flushBatch();
+        }
+        return;
+    }
+    if (isBusy()) {
+        if (m_hasHeldSample) {
+            m_coalescedSamples++;
+        }
+        m_heldSample = sample;
+        m_hasHeldSample = true;
+        return;
+    }
+    send(sample);
+}
+
+bool HttpSink::isBusy() const
+{
+    return !isBatching() && isWindowFull();
+}
+
+bool HttpSink::isWindowFull() const
+{
+    return m_maxInFlight > 0 && m_pendingRequests >= m_maxInFlight;
+}
+
+void HttpSink::flushBatch()
+{
+    if (m_batchCount == 0) {
+        return;
+    }
+    if (isWindowFull()) {
+        m_batchDue = true;
+        return;
+    }
+    sendBatch();
+}
+
+void HttpSink::sendBatch()
+{
+    m_batchDue = false;
+    m_batchTimer.stop();
+
+    char length[FastFormat::MaxIntLength];
+    const char *lengthEnd = FastFormat::appendInt(length, m_batchBody.size() + 2);
+    m_batchRequest.resize(0);
+    m_batchRequest.append(m_batchHead);
+    m_batchRequest.append(length, static_cast<int>(lengthEnd - length));
+    m_batchRequest.append("\r\n\r\n[");
+    m_batchRequest.append(m_batchBody);
+    m_batchRequest.append(']');
+
+    m_socket.write(m_batchRequest);
+    m_requestTimes[m_sentRequests++ % MaxTimedRequests] = MonotonicClock::now();
+    m_pendingRequests++;
+    m_batchBody.resize(0);
+    m_batchCount = 0;
+}
+
+void HttpSink::dropBatch()
+{
+    m_droppedSamples += m_batchCount;
+    m_batchTimer.stop();
+    m_batchBody.resize(0);
+    m_batchCount = 0;
+    m_batchDue = false;
+}
+
+void HttpSink::send(const AttitudeSample &sample)
+{
+    char *out = m_request.data() + m_requestHeadSize;
+    out = FastFormat::appendFixed(out, sample.roll);
+    *out++ = ',';
+    out = FastFormat::appendFixed(out, sample.pitch);
+    *out++ = ',';
+    out = FastFormat::appendFixed(out, sample.yaw);
+    memcpy(out, m_requestTail.constData(), m_requestTail.size());
+    out += m_requestTail.size();
+
+#ifdef DEBUG
+    qDebug().noquote() << QByteArray(m_request.data(), out - m_request.data());
+#endif
+    m_socket.write(m_request.data(), out - m_request.data());
+    m_requestTimes[m_sentRequests++ % MaxTimedRequests] = MonotonicClock::now();
+    m_pendingRequests++;
+}
+
+void HttpSink::sendHeldSample()
+{
+    if (m_batchDue) {
+        flushBatch();
+    }
+    if (m_hasHeldSample && !isBusy()) {
+        m_hasHeldSample = false;
+        send(m_heldSample);
+    }
+}
+
+void HttpSink::connectToServer()
+{
+    if (!m_open || m_socket.state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    m_responseSize = 0;
+    m_bodyLeft = 0;
+    m_pendingRequests = 0;
+    m_socket.connectToHost(m_url.host(), static_cast<quint16>(m_url.port(80)));
+}
+
+void HttpSink::handleConnected()
+{
+    // Requests are small, don't let Nagle's algorithm hold them back
+    m_socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_socket.setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+}
+
+void HttpSink::handleReadyRead()
+{
+    for (;;) {
+        const qint64 size = m_socket.read(m_response + m_responseSize,
+                                          sizeof(m_response) - m_responseSize);
+        if (size <= 0) {
+            break;
+        }
+        m_responseSize += static_cast<int>(size);
+        if (!parseResponses()) {
+            qWarning().noquote() << tr("Warning: Malformed HTTP response from '%1'.")
+                                    .arg(m_url.toString());
+            m_socket.abort();
+            return;
+        }
+    }
+    sendHeldSample();
+    if (!isBusy()) {
+        emit ready();
+    }
+}
+
+void HttpSink::handleStateChanged(QAbstractSocket::SocketState state)
+{
+    if (state != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    if (m_pendingRequests > 0) {
+        qWarning().noquote() << tr("Warning: HTTP connection to '%1' lost, "
+                                   "%2 requests not answered.")
+                                .arg(m_url.toString())
+                                .arg(m_pendingRequests);
+    }
+    m_pendingRequests = 0;
+    if (m_hasHeldSample) {
+        // Stale by the time we reconnect
+        m_hasHeldSample = false;
+        m_droppedSamples++;
+    }
+    dropBatch();
+    if (m_open && !m_reconnectTimer.isActive()) {
+        m_reconnectTimer.start();
+    }
+}
+
+bool HttpSink::parseResponses()
+{
+    int offset = 0;
+    while (offset < m_responseSize) {
+        if (m_bodyLeft != 0) {
+            // Body is not used, skip it
+            const int available = m_responseSize - offset;
+            if (m_bodyLeft < 0 || m_bodyLeft >= available) {
+                if (m_bodyLeft > 0) {
+                    m_bodyLeft -= available;
+                }
+                offset = m_responseSize;
+                break;
+            }
+            offset += static_cast<int>(m_bodyLeft);
+            m_bodyLeft = 0;
+            continue;
+        }
+
+        const char *begin = m_response + offset;
+        const int available = m_responseSize - offset;
+        const char *end = Q_NULLPTR;
+        for (const char *p = begin; p + 3 < begin + available; ++p) {
+            p = static_cast<const char *>(memchr(p, '\r', begin + available - 3 - p));
+            if (!p) {
+                break;
+            }
+            if (memcmp(p, "\r\n\r\n", 4) == 0) {
+                end = p;
+                break;
+            }
+        }
+        if (!end) {
+            // Incomplete headers must fit into the buffer
+            if (offset == 0 && m_responseSize == MaxResponseHeaderSize) {
+                return false;
+            }
+            break;
+        }
+        if (!parseHeaders(begin, static_cast<int>(end - begin))) {
+            return false;
+        }
+        offset += static_cast<int>(end - begin) + 4;
+    }
+
+    m_responseSize -= offset;
+    memmove(m_response, m_response + offset, m_responseSize);
+    return true;
+}
+
+bool HttpSink::parseHeaders(const char *headers, int size)
+{
+    // "HTTP/1.1 200 OK"
+    if (size < 12 || memcmp(headers, "HTTP/1.", 7) != 0 || headers[8] != ' ') {
+        return false;
+    }
+    int status = 0;
+    for (int i = 9; i < 12; ++i) {
+        if (headers[i] < '0' || headers[i] > '9') {
+            return false;
+        }
+        status = status * 10 + headers[i] - '0';
+    }
+
+    bool hasLength = false;
+    qint64 length = 0;
+    const char *end = headers + size;
+    const char *line = static_cast<const char *>(memchr(headers, '\n', size));
+    while (line && ++line < end) {
+        const char *next = static_cast<const char *>(memchr(line, '\n', end - line));
+        const int lineSize = static_cast<int>((next ? next : end) - line);
+        const char *value;
+        if ((value = headerValue(line, lineSize, "content-length:"))) {
+            hasLength = true;
+            length = 0;
+            for (; value < line + lineSize && *value >= '0' && *value <= '9'; ++value) {
+                length = length * 10 + *value - '0';
+            }
+        } else if ((value = headerValue(line, lineSize, "transfer-encoding:"))) {
+            // Chunked bodies are not supported
+            return false;
+        }
+        line = next;
+    }
+
+    if (status >= 100 && status < 200) {
+        // Interim response, the final one follows
+        return true;
+    }
+    if (status < 200 || status >= 300) {
+        m_failedRequests++;
+        qWarning().noquote() << tr("Warning: HTTP request failed ('%1', status %2).")
+                                .arg(m_url.toString())
+                                .arg(status);
+    }
+    if (m_pendingRequests > 0) {
+        // Responses come in the order of the requests
+        if (m_pendingRequests <= MaxTimedRequests) {
+            const quint64 request = m_sentRequests - m_pendingRequests;
+            const qint64 timeNs = MonotonicClock::now() - m_requestTimes[request % MaxTimedRequests];
+            m_responseTimeNs = m_responseTimeNs ? (7 * m_responseTimeNs + timeNs) / 8 : timeNs;
+        }
+        m_pendingRequests--;
+    }
+    if (status == 204 || status == 304) {
+        m_bodyLeft = 0;
+    } else {
+        // Without Content-Length the body lasts until the connection closes
+        m_bodyLeft = hasLength ? length : -1;
+    }
+    return true;
+}
+
+void HttpSink::reportStatistics()
+{
+    if (m_droppedSamples == m_reportedDroppedSamples
+            && m_coalescedSamples == m_reportedCoalescedSamples) {
+        return;
+    }
+    qInfo().noquote() << tr("HTTP output: %1 samples dropped, %2 coalesced.")
+                         .arg(m_droppedSamples)
+                         .arg(m_coalescedSamples);
+    m_reportedDroppedSamples = m_droppedSamples;
+    m_reportedCoalescedSamples = m_coalescedSamples;
+}
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file http_sink.h
+ * @brief File contains a declaration of the HTTP attitude output - HttpSink
+ */
+
+#ifndef HTTP_SINK_H
+#define HTTP_SINK_H
+
+#include <QByteArray>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+
+#include <vector>
+
+#include "attitude_sink.h"
+
+namespace C {
+/**
+ * @brief Default Camera Adapter host
+ */
+const char * const ApiHost = "http://127.0.0.1:8123";
+/**
+ * @brief Default Camera Adapter API path
+ */
+const char * const ApiPath = "/api/v1";
+}
+
+/**
+ * @brief Attitude output posting samples to the Camera Adapter HTTP API
+ *
+ * Every sample is sent as "POST <path>/attitude/<roll>,<pitch>,<yaw>" over
+ * one persistent HTTP/1.1 connection. The request is formatted into a buffer
+ * prepared by open(), only the angles are written per sample. Responses are
+ * parsed in place: the status line and Content-Length are read, bodies are
+ * skipped. A lost connection is re-established after ReconnectInterval,
+ * samples are dropped while disconnected.
+ *
+ * By default a request is sent only once the previous one is answered,
+ * deeper pipelining is opt-in (see setMaxInFlight()). When the window is full,
+ * the newest sample is held back and replaced by any later one (latest value
+ * wins), so a slow server gets fresh attitude instead of a growing backlog.
+ *
+ * In batch mode samples are collected instead and posted together as
+ * "POST <path>/attitude" with a JSON array body (see AttitudeJson). A batch
+ * is sent when it holds the configured number of samples or when the batch
+ * interval has passed since its first sample, so an idle stream is flushed
+ * too. A batch waits while the in-flight window is full.
+ *
+ * Dropped and coalesced samples are reported every StatisticsInterval if
+ * their counts grew, and once more by close().
+ *
+ * Only plain "http" URLs are supported.
+ */
+class HttpSink : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Delay before reconnecting after a connection loss (ms)
+     */
+    static const int ReconnectInterval = 1000;
+    /**
+     * @brief Maximal size of response headers
+     */
+    static const int MaxResponseHeaderSize = 4096;
+    /**
+     * @brief Batch interval used if only the batch size is set (ms)
+     */
+    static const int DefaultBatchInterval = 100;
+    /**
+     * @brief Maximal number of samples in a batch, further ones are dropped
+     */
+    static const int MaxBatchSamples = 1000;
+    /**
+     * @brief Number of requests in flight whose send times are kept
+     */
+    static const int MaxTimedRequests = 64;
+    /**
+     * @brief Time close() waits for the last batch to be written (ms)
+     */
+    static const int CloseTimeout = 500;
+    /**
+     * @brief Default maximal number of requests in flight: plain request/response
+     */
+    static const int DefaultMaxInFlight = 1;
+    /**
+     * @brief Interval of the dropped and coalesced samples report (ms)
+     */
+    static const int StatisticsInterval = 10000;
+
+    HttpSink(QObject *parent = Q_NULLPTR);
+    virtual ~HttpSink();
+
+    /**
+     * @brief Set the API base URL
+     * @param url API base URL, "http://127.0.0.1:8123/api/v1" by default
+     */
+    void setUrl(const QUrl &url) { m_url = url; }
+    /**
+     * @brief Get the API base URL
+     * @return API base URL
+     */
+    QUrl url() const { return m_url; }
+
+    /**
+     * @brief Limit the number of unanswered requests
+     *
+     * Values above 1 pipeline requests on the connection, which not every
+     * server handles.
+     *
+     * @param count maximal number of requests in flight, 0 for no limit
+     */
+    void setMaxInFlight(int count) { m_maxInFlight = count; }
+    /**
+     * @brief Get the limit of unanswered requests
+     * @return Maximal number of requests in flight, 0 if not limited
+     */
+    int maxInFlight() const { return m_maxInFlight; }
+
+    /**
+     * @brief Enable the batch mode
+     * @param size samples per batch, 0 to send by time only
+     * @param interval maximal time a sample waits for its batch (ms),
+     *                 0 for DefaultBatchInterval
+     */
+    void setBatch(int size, int interval);
+    /**
+     * @brief Check if the batch mode is enabled
+     * @return true if samples are posted in batches
+     */
+    bool isBatching() const { return m_batchSize > 1 || m_batchInterval > 0; }
+
+    /**
+     * @brief Prepare the request buffer and connect to the server
+     * @return true on success, false if the URL is not supported
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Disconnect from the server
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Post an attitude sample
+     *
+     * The sample is dropped if the connection is not established and held
+     * back if the in-flight window is full.
+     *
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+    /**
+     * @brief Check if the in-flight window is full
+     *
+     * Never busy in batch mode, where samples wait in the batch.
+     *
+     * @return true if a sample written now would be held back
+     */
+    bool isBusy() const Q_DECL_OVERRIDE;
+
+    /**
+     * @brief Get the number of requests answered with an error status
+     * @return Failed requests count
+     */
+    quint64 failedRequests() const { return m_failedRequests; }
+    /**
+     * @brief Get the number of samples dropped while disconnected
+     * @return Dropped samples count
+     */
+    quint64 droppedSamples() const Q_DECL_OVERRIDE { return m_droppedSamples; }
+    /**
+     * @brief Get the number of held back samples replaced by newer ones
+     * @return Coalesced samples count
+     */
+    quint64 coalescedSamples() const { return m_coalescedSamples; }
+
+    /**
+     * @brief Get the average response time
+     * @return Time from sending a request to its response (ns), 0 if unknown
+     */
+    qint64 deliveryTimeNs() const Q_DECL_OVERRIDE { return m_responseTimeNs; }
+
+private slots:
+    /**
+     * @brief Connect to the server
+     */
+    void connectToServer();
+    /**
+     * @brief Tune the socket once connected
+     */
+    void handleConnected();
+    /**
+     * @brief Read and parse available response data
+     */
+    void handleReadyRead();
+    /**
+     * @brief Schedule a reconnect after the connection is closed or failed
+     * @param state new socket state
+     */
+    void handleStateChanged(QAbstractSocket::SocketState state);
+    /**
+     * @brief Send the current batch if the in-flight window allows
+     */
+    void flushBatch();
+    /**
+     * @brief Report dropped and coalesced samples if there are new ones
+     */
+    void reportStatistics();
+
+private:
+    /**
+     * @brief Format and send a request for a sample
+     * @param sample attitude sample with angles in radians
+     */
+    void send(const AttitudeSample &sample);
+    /**
+     * @brief Send the held back sample if the in-flight window allows
+     */
+    void sendHeldSample();
+    /**
+     * @brief Check if the in-flight window is full
+     * @return true if no request may be sent now
+     */
+    bool isWindowFull() const;
+    /**
+     * @brief Send the current batch regardless of the in-flight window
+     */
+    void sendBatch();
+    /**
+     * @brief Drop the current batch
+     */
+    void dropBatch();
+    /**
+     * @brief Parse complete responses in m_response and drop them
+     * @return true on success, false on a malformed or unsupported response
+     */
+    bool parseResponses();
+    /**
+     * @brief Parse the headers of one response
+     * @param headers response headers without the final empty line
+     * @param size size of @p headers
+     * @return true on success, false on a malformed or unsupported response
+     */
+    bool parseHeaders(const char *headers, int size);
+
+private:
+    /**
+     * @brief API base URL
+     */
+    QUrl m_url;
+    /**
+     * @brief Persistent connection to the server
+     */
+    QTcpSocket m_socket;
+    /**
+     * @brief Timer restoring a lost connection
+     */
+    QTimer m_reconnectTimer;
+    /**
+     * @brief Whether the sink is open
+     */
+    bool m_open = false;
+
+    /**
+     * @brief Request buffer, starts with the request line prefix
+     */
+    std::vector<char> m_request;
+    /**
+     * @brief Size of the request line prefix in m_request
+     */
+    int m_requestHeadSize = 0;
+    /**
+     * @brief Request line suffix and headers following the angles
+     */
+    QByteArray m_requestTail;
+
+    /**
+     * @brief Samples per batch, 0 or 1 if not limited by count
+     */
+    int m_batchSize = 0;
+    /**
+     * @brief Maximal time a sample waits for its batch (ms), 0 for default
+     */
+    int m_batchInterval = 0;
+    /**
+     * @brief Timer sending a batch after the batch interval
+     */
+    QTimer m_batchTimer;
+    /**
+     * @brief Batch request line and headers up to the Content-Length value
+     */
+    QByteArray m_batchHead;
+    /**
+     * @brief JSON objects of the current batch, separated by commas
+     */
+    QByteArray m_batchBody;
+    /**
+     * @brief Batch request buffer, reused
+     */
+    QByteArray m_batchRequest;
+    /**
+     * @brief Number of samples in the current batch
+     */
+    int m_batchCount = 0;
+    /**
+     * @brief Whether the current batch is due and waits for the window
+     */
+    bool m_batchDue = false;
+    /**
+     * @brief Sequence number of the last batched sample
+     */
+    quint64 m_seq = 0;
+
+    /**
+     * @brief Unparsed response data
+     */
+    char m_response[MaxResponseHeaderSize];
+    /**
+     * @brief Size of the data in m_response
+     */
+    int m_responseSize = 0;
+    /**
+     * @brief Body bytes of the current response left to skip, -1 until close
+     */
+    qint64 m_bodyLeft = 0;
+    /**
+     * @brief Requests sent but not answered yet
+     */
+    int m_pendingRequests = 0;
+    /**
+     * @brief Requests sent since the connection was established
+     */
+    quint64 m_sentRequests = 0;
+    /**
+     * @brief Send times of the latest requests (ns), a ring of MaxTimedRequests entries
+     */
+    qint64 m_requestTimes[MaxTimedRequests];
+    /**
+     * @brief Average response time (ns)
+     */
+    qint64 m_responseTimeNs = 0;
+    /**
+     * @brief Maximal number of requests in flight, 0 for no limit
+     */
+    int m_maxInFlight = DefaultMaxInFlight;
+    /**
+     * @brief Newest sample waiting for room in the in-flight window
+     */
+    AttitudeSample m_heldSample;
+    /**
+     * @brief Whether m_heldSample is valid
+     */
+    bool m_hasHeldSample = false;
+
+    /**
+     * @brief Requests answered with an error status
+     */
+    quint64 m_failedRequests = 0;
+    /**
+     * @brief Samples dropped while disconnected
+     */
+    quint64 m_droppedSamples = 0;
+    /**
+     * @brief Held back samples replaced by newer ones
+     */
+    quint64 m_coalescedSamples = 0;
+    /**
+     * @brief Timer reporting dropped and coalesced samples
+     */
+    QTimer m_statisticsTimer;
+    /**
+     * @brief m_droppedSamples at the last report
+     */
+    quint64 m_reportedDroppedSamples = 0;
+    /**
+     * @brief m_coalescedSamples at the last report
+     */
+    quint64 m_reportedCoalescedSamples = 0;
+};
+
+#endif // #ifndef HTTP_SINK_H
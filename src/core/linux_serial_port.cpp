@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "linux_serial_port.h"
+
+#include <QDebug>
+
+// termios2 lives in asm/termbits.h, which conflicts with termios.h
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+LinuxSerialPort::LinuxSerialPort(QObject *parent) : QIODevice(parent)
+{
+}
+
+LinuxSerialPort::~LinuxSerialPort()
+{
+    close();
+}
+
+bool LinuxSerialPort::open(OpenMode mode)
+{
+    if (isOpen()) {
+        close();
+    }
+
+    int flags = O_NOCTTY | O_NONBLOCK | O_CLOEXEC;
+    flags |= (mode & ReadWrite) == ReadWrite ? O_RDWR :
+             (mode & WriteOnly) ? O_WRONLY : O_RDONLY;
+    m_fd = ::open(m_portName.toLocal8Bit().constData(), flags);
+    if (m_fd < 0) {
+        setSystemError(tr("open"));
+        return false;
+    }
+    if (!configure()) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    setLowLatency();
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated,
+            this, &LinuxSerialPort::readyRead);
+
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void LinuxSerialPort::close()
+{
+    if (m_fd < 0) {
+        return;
+    }
+    QIODevice::close();
+    delete m_notifier;
+    m_notifier = Q_NULLPTR;
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+bool LinuxSerialPort::clear()
+{
+    if (m_fd < 0) {
+        return false;
+    }
+    return ::ioctl(m_fd, TCFLSH, TCIOFLUSH) == 0;
+}
+
+qint64 LinuxSerialPort::bytesAvailable() const
+{
+    int available = 0;
+    if (m_fd < 0 || ::ioctl(m_fd, FIONREAD, &available) != 0) {
+        return 0;
+    }
+    return available;
+}
+
+qint64 LinuxSerialPort::readData(char *data, qint64 maxSize)
+{
+    const ssize_t size = ::read(m_fd, data, maxSize);
+    if (size > 0 || (size == 0 && maxSize == 0)) {
+        return size;
+    }
+    if (size == 0) {
+        // An empty non-blocking tty with VMIN=1 fails with EAGAIN, end of
+        // file is a hangup. The notifier would keep firing, stop polling.
+        setErrorString(tr("read: hangup"));
+        m_notifier->setEnabled(false);
+        return -1;
+    }
+    if (errno == EAGAIN || errno == EINTR) {
+        return 0;
+    }
+    // The device is gone (e.g. unplugged USB adapter), stop polling it
+    setSystemError(tr("read"));
+    m_notifier->setEnabled(false);
+    return -1;
+}
+
+qint64 LinuxSerialPort::writeData(const char *data, qint64 maxSize)
+{
+    const ssize_t size = ::write(m_fd, data, maxSize);
+    if (size >= 0) {
+        return size;
+    }
+    if (errno == EAGAIN || errno == EINTR) {
+        return 0;
+    }
+    setSystemError(tr("write"));
+    return -1;
+}
+
+bool LinuxSerialPort::configure()
+{
+    struct termios2 tio;
+    if (::ioctl(m_fd, TCGETS2, &tio) != 0) {
+        setSystemError(tr("TCGETS2"));
+        return false;
+    }
+
+    // Raw mode, 8N1, no flow control
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR |
+                     ICRNL | IXON | IXOFF | IXANY);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS);
+    tio.c_cflag |= CS8 | CREAD | CLOCAL;
+
+    // Wake up on the first byte, don't wait for the inter-byte timer
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    // Arbitrary baud rate
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_ispeed = m_baudRate;
+    tio.c_ospeed = m_baudRate;
+
+    if (::ioctl(m_fd, TCSETS2, &tio) != 0) {
+        setSystemError(tr("TCSETS2"));
+        return false;
+    }
+    return true;
+}
+
+void LinuxSerialPort::setLowLatency()
+{
+    struct serial_struct serial;
+    if (::ioctl(m_fd, TIOCGSERIAL, &serial) != 0) {
+        return;
+    }
+    serial.flags |= ASYNC_LOW_LATENCY;
+    if (::ioctl(m_fd, TIOCSSERIAL, &serial) != 0) {
+        qWarning().noquote() << tr("Warning: %1 doesn't support low latency mode.")
+                                .arg(m_portName);
+    }
+}
+
+void LinuxSerialPort::setSystemError(const QString &what)
+{
+    setErrorString(QString("%1: %2").arg(what).arg(QString::fromLocal8Bit(strerror(errno))));
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file linux_serial_port.h
+ * @brief File contains a declaration of the low-latency Linux serial port - LinuxSerialPort
+ */
+
+#ifndef LINUX_SERIAL_PORT_H
+#define LINUX_SERIAL_PORT_H
+
+#include <QIODevice>
+#include <QSocketNotifier>
+
+/**
+ * @brief Low-latency serial port backend for Linux
+ *
+ * Opens the tty directly instead of going through QSerialPort:
+ * - the port is put into raw mode with VMIN=1 and VTIME=0, so the reader is
+ *   woken up by the first received byte;
+ * - ASYNC_LOW_LATENCY is requested via TIOCSSERIAL, which e.g. drops the FTDI
+ *   latency timer from 16 ms to 1 ms;
+ * - the baud rate is set through termios2, so non-standard rates work;
+ * - the device is unbuffered, read() goes straight to the tty.
+ *
+ * The descriptor is watched by a QSocketNotifier, i.e. by the epoll/poll
+ * based dispatcher of the thread the port lives in.
+ */
+class LinuxSerialPort : public QIODevice
+{
+    Q_OBJECT
+public:
+    LinuxSerialPort(QObject *parent = Q_NULLPTR);
+    virtual ~LinuxSerialPort();
+
+    /**
+     * @brief Set the tty device to open
+     * @param portName path like /dev/ttyUSB0
+     */
+    void setPortName(const QString &portName) { m_portName = portName; }
+    /**
+     * @brief Get the tty device
+     * @return Path of the tty device
+     */
+    QString portName() const { return m_portName; }
+
+    /**
+     * @brief Set the baud rate used on the next open()
+     * @param baudRate any rate supported by the UART, not only standard ones
+     */
+    void setBaudRate(qint32 baudRate) { m_baudRate = baudRate; }
+    /**
+     * @brief Get the baud rate
+     * @return Baud rate in bauds per second
+     */
+    qint32 baudRate() const { return m_baudRate; }
+
+    /**
+     * @brief Open and configure the tty (8N1, no flow control)
+     * @param mode open mode, always made unbuffered
+     * @return true on success, false otherwise
+     */
+    bool open(OpenMode mode) Q_DECL_OVERRIDE;
+    /**
+     * @brief Close the tty
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Discard data in the tty input and output queues
+     * @return true on success, false otherwise
+     */
+    bool clear();
+
+    bool isSequential() const Q_DECL_OVERRIDE { return true; }
+    qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private:
+    /**
+     * @brief Apply raw mode and baud rate to the open descriptor
+     * @return true on success, false otherwise
+     */
+    bool configure();
+    /**
+     * @brief Ask the driver for low-latency mode
+     */
+    void setLowLatency();
+    /**
+     * @brief Set error string from errno
+     * @param what failed operation
+     */
+    void setSystemError(const QString &what);
+
+private:
+    /**
+     * @brief Path of the tty device
+     */
+    QString m_portName;
+    /**
+     * @brief Baud rate in bauds per second
+     */
+    qint32 m_baudRate = 57600;
+    /**
+     * @brief Descriptor of the open tty, -1 if closed
+     */
+    int m_fd = -1;
+    /**
+     * @brief Read readiness notifier of m_fd
+     */
+    QSocketNotifier *m_notifier = Q_NULLPTR;
+};
+
+#endif // #ifndef LINUX_SERIAL_PORT_H
@@ -26,14 +26,17 @@
  *
  */
  
+#include "clock_sync.h"
 #include "core.h"
 #include "mavlink_interface.h"
+#include "sink_config.h"
 
 #include <app_version.h>
 
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QHostAddress>
 
 #include <vector>
 #include <signal.h>
@@ -70,6 +73,10 @@ int main(int argc, char *argv[])
                                     tr("serial"));
     parser.addOption(serialOption);
 
+    QCommandLineOption lowLatencyOption(QStringList() << "low-latency",
+                                        tr("Use the low-latency native serial backend (Linux only)."));
+    parser.addOption(lowLatencyOption);
+
     QCommandLineOption networkOption(QStringList() << "n" << "network",
                                      tr("MAVLink network device address (e.g. localhost or 127.0.0.1)."),
                                      tr("network"), "127.0.0.1");
@@ -79,12 +86,92 @@ int main(int argc, char *argv[])
                                   tr("port"), "5760");
     parser.addOption(portOption);
 
+    QCommandLineOption udpOption(QStringList() << "u" << "udp",
+                                 tr("Local UDP port to receive MAVLink datagrams on (e.g. 14550)."),
+                                 tr("udp"));
+    parser.addOption(udpOption);
+    QCommandLineOption udpAllowOption(QStringList() << "udp-allow",
+                                      tr("Accept MAVLink datagrams only from this address (may be repeated)."),
+                                      tr("address"));
+    parser.addOption(udpAllowOption);
+
+    QCommandLineOption ioThreadOption(QStringList() << "io-thread",
+                                      tr("Read and parse MAVLink data on a dedicated thread."));
+    parser.addOption(ioThreadOption);
+    QCommandLineOption ioCpuOption(QStringList() << "io-cpu",
+                                   tr("Pin the MAVLink I/O thread to a CPU core (implies --io-thread)."),
+                                   tr("cpu"));
+    parser.addOption(ioCpuOption);
+
+    QCommandLineOption noTimesyncOption(QStringList() << "no-timesync",
+                                        tr("Don't exchange TIMESYNC messages with the autopilot, synchronise its clock from SYSTEM_TIME only."));
+    parser.addOption(noTimesyncOption);
+    QCommandLineOption attitudeRateOption(QStringList() << "attitude-rate",
+                                          tr("Rate to request attitude messages at (Hz)."),
+                                          tr("rate"), "10");
+    parser.addOption(attitudeRateOption);
+    QCommandLineOption attitudeQuaternionOption(QStringList() << "attitude-quaternion",
+                                                tr("Take the attitude from ATTITUDE_QUATERNION instead of ATTITUDE messages."));
+    parser.addOption(attitudeQuaternionOption);
+    QCommandLineOption adaptiveRateOption(QStringList() << "adaptive-rate",
+                                          tr("Adapt the attitude rate to the link and output load, up to this rate (Hz)."),
+                                          tr("max-rate"));
+    parser.addOption(adaptiveRateOption);
+
+    QCommandLineOption sinkOption(QStringList() << "sink",
+                                  tr("Attitude output '<type>:<target>[,<option>...]' replacing the default HTTP output (may be repeated)."),
+                                  tr("spec"));
+    parser.addOption(sinkOption);
+    QCommandLineOption configOption(QStringList() << "config",
+                                    tr("INI file with attitude outputs replacing the default HTTP output."),
+                                    tr("file"));
+    parser.addOption(configOption);
+
+    QCommandLineOption maxInFlightOption(QStringList() << "max-in-flight",
+                                         tr("Maximal number of unanswered requests of the default HTTP output, more than 1 pipelines requests, newer samples replace held back ones (0 for no limit)."),
+                                         tr("count"), "1");
+    parser.addOption(maxInFlightOption);
+    QCommandLineOption predictOption(QStringList() << "predict",
+                                     tr("Compensate the latency of the default HTTP output, projecting attitude the given time beyond its delivery (e.g. 0)."),
+                                     tr("ms"));
+    parser.addOption(predictOption);
+
+    QCommandLineOption webSocketOption(QStringList() << "websocket",
+                                       tr("Also stream attitude to a WebSocket server (e.g. 'ws://127.0.0.1:8124/attitude')."),
+                                       tr("url"));
+    parser.addOption(webSocketOption);
+
+    QCommandLineOption udpOutOption(QStringList() << "udp-out",
+                                    tr("Also send binary attitude records to a UDP address or multicast group (e.g. '239.0.0.1:14600', may be repeated)."),
+                                    tr("address:port"));
+    parser.addOption(udpOutOption);
+    QCommandLineOption multicastTtlOption(QStringList() << "multicast-ttl",
+                                          tr("Time-to-live of multicast attitude records."),
+                                          tr("ttl"), "1");
+    parser.addOption(multicastTtlOption);
+    QCommandLineOption httpServerOption(QStringList() << "http-server",
+                                        tr("Also serve attitude over HTTP on a local port (e.g. '8125' or '0.0.0.0:8125')."),
+                                        tr("[address:]port"));
+    parser.addOption(httpServerOption);
+#ifdef Q_OS_UNIX
+    QCommandLineOption unixOutOption(QStringList() << "unix-out",
+                                     tr("Also send binary attitude records to a Unix datagram socket (may be repeated)."),
+                                     tr("path"));
+    parser.addOption(unixOutOption);
+    QCommandLineOption shmOption(QStringList() << "shm",
+                                 tr("Also publish attitude in POSIX shared memory (e.g. '/attfeeder')."),
+                                 tr("name"));
+    parser.addOption(shmOption);
+#endif
+
     parser.process(app);
 
     auto core = new Core(&app);
     // One and only one MAVLink device type must be specified!
-    if (!(parser.isSet(serialOption) ^
-            (parser.isSet(networkOption) && parser.isSet(portOption)))) {
+    const int deviceTypes = (parser.isSet(serialOption) ? 1 : 0) +
+            ((parser.isSet(networkOption) && parser.isSet(portOption)) ? 1 : 0) +
+            (parser.isSet(udpOption) ? 1 : 0);
+    if (deviceTypes != 1) {
         qCritical().noquote() << tr("One and only one MAVLink device type must be specified!") << endl;
         parser.showHelp(1);
         Q_UNREACHABLE();
@@ -92,6 +179,7 @@ int main(int argc, char *argv[])
         QString serialName = parser.value(serialOption);
 
         core->mavlinkInterface()->setSerialName(serialName);
+        core->mavlinkInterface()->setLowLatencySerial(parser.isSet(lowLatencyOption));
         core->mavlinkInterface()->setSerialInterface();
     } else if (parser.isSet(networkOption) && parser.isSet(portOption)) {
         QString networkAddr = parser.value(networkOption);
@@ -100,6 +188,95 @@ int main(int argc, char *argv[])
         core->mavlinkInterface()->setTcpAddress(networkAddr);
         core->mavlinkInterface()->setTcpPort(port);
         core->mavlinkInterface()->setTcpInterface();
+    } else if (parser.isSet(udpOption)) {
+        QList<QHostAddress> senders;
+        for (const QString &address : parser.values(udpAllowOption)) {
+            const QHostAddress sender(address);
+            if (sender.isNull()) {
+                qCritical().noquote() << tr("Invalid UDP sender address '%1'.").arg(address);
+                return 1;
+            }
+            senders << sender;
+        }
+
+        core->mavlinkInterface()->setUdpPort(parser.value(udpOption).toUShort());
+        core->mavlinkInterface()->setUdpAllowedSenders(senders);
+        core->mavlinkInterface()->setUdpInterface();
+    }
+
+    core->setAttitudeRate(parser.value(attitudeRateOption).toFloat());
+    core->setQuaternionAttitude(parser.isSet(attitudeQuaternionOption));
+    if (parser.isSet(adaptiveRateOption)) {
+        core->setAdaptiveRate(parser.value(adaptiveRateOption).toDouble());
+    }
+    if (parser.isSet(noTimesyncOption)) {
+        core->mavlinkInterface()->clockSync()->setTimesyncEnabled(false);
+    }
+
+    if (parser.isSet(ioThreadOption) || parser.isSet(ioCpuOption)) {
+        int cpu = parser.isSet(ioCpuOption) ? parser.value(ioCpuOption).toInt() : -1;
+        core->setIoThread(true, cpu);
+    }
+
+    // Attitude outputs
+    QList<SinkConfig::Entry> sinks;
+    QString error;
+    bool sinksOk = true;
+    auto addSink = [&](const QString &type, const QString &target,
+                       const QMap<QString, QString> &options) {
+        SinkConfig::Entry entry;
+        sinksOk = sinksOk && SinkConfig::create(type, target, options, &entry, &error);
+        if (sinksOk) {
+            sinks << entry;
+        }
+    };
+    if (parser.isSet(configOption)) {
+        sinksOk = SinkConfig::load(parser.value(configOption), &sinks, &error);
+    }
+    for (const QString &spec : parser.values(sinkOption)) {
+        SinkConfig::Entry entry;
+        sinksOk = sinksOk && SinkConfig::parse(spec, &entry, &error);
+        if (sinksOk) {
+            sinks << entry;
+        }
+    }
+    if (!parser.isSet(configOption) && !parser.isSet(sinkOption)) {
+        // Camera Adapter at its default URL
+        QMap<QString, QString> options;
+        options.insert("inflight", parser.value(maxInFlightOption));
+        if (parser.isSet(predictOption)) {
+            options.insert("predict", parser.value(predictOption));
+        }
+        addSink("http", QString(), options);
+    }
+    if (parser.isSet(webSocketOption)) {
+        addSink("ws", parser.value(webSocketOption), QMap<QString, QString>());
+    }
+    for (const QString &destination : parser.values(udpOutOption)) {
+        QMap<QString, QString> options;
+        options.insert("ttl", parser.value(multicastTtlOption));
+        addSink("udp", destination, options);
+    }
+    if (parser.isSet(httpServerOption)) {
+        addSink("server", parser.value(httpServerOption), QMap<QString, QString>());
+    }
+#ifdef Q_OS_UNIX
+    for (const QString &path : parser.values(unixOutOption)) {
+        addSink("unix", path, QMap<QString, QString>());
+    }
+    if (parser.isSet(shmOption)) {
+        addSink("shm", parser.value(shmOption), QMap<QString, QString>());
+    }
+#endif
+    if (!sinksOk) {
+        qCritical().noquote() << error;
+        for (const SinkConfig::Entry &entry : sinks) {
+            delete entry.sink;
+        }
+        return 1;
+    }
+    for (const SinkConfig::Entry &entry : sinks) {
+        core->addSink(entry.sink, entry.policy);
     }
 
     signal(SIGINT, quit);
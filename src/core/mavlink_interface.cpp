@@ -27,6 +27,9 @@
  */
  
 #include "mavlink_interface.h"
+#include "clock_sync.h"
+#include "message_rates.h"
+#include "monotonic_clock.h"
 
 #include <QSerialPortInfo>
 
@@ -34,15 +37,56 @@
 
 #include <common/mavlink.h>
 
-MavlinkInterface::MavlinkInterface(QObject *parent) : QObject(parent)
+namespace {
+const size_t RxBufferSize = 16384;
+// Start bit, 8 data bits, stop bit
+const int BitsPerByte = 10;
+
+/**
+ * @brief MAVLink messages handled by ClockSync
+ */
+const MavlinkMessageIds ClockSyncMessageIds =
+        mavlinkMessageIds<MAVLINK_MSG_ID_SYSTEM_TIME,
+                          MAVLINK_MSG_ID_TIMESYNC>();
+
+/**
+ * @brief MAVLink messages handled by MessageRates
+ */
+const MavlinkMessageIds MessageRatesMessageIds =
+        mavlinkMessageIds<MAVLINK_MSG_ID_HEARTBEAT,
+                          MAVLINK_MSG_ID_COMMAND_ACK>();
+}
+
+MavlinkInterface::MavlinkInterface(QObject *parent) :
+    QObject(parent), m_serialPort(this),
+#ifdef Q_OS_LINUX
+    m_nativeSerialPort(this),
+#endif
+    m_tcpSocket(this), m_udpLink(this), m_rxBuffer(RxBufferSize),
+    m_receivedBytes(0), m_receivedFrames(0), m_lostFrames(0), m_linkCapacity(0)
 {
     connect(&m_serialPort, &QSerialPort::readyRead,
             this, &MavlinkInterface::getSerialData);
+#ifdef Q_OS_LINUX
+    connect(&m_nativeSerialPort, &LinuxSerialPort::readyRead,
+            this, &MavlinkInterface::getSerialData);
+#endif
 
     connect(&m_tcpSocket, &QTcpSocket::readyRead,
             this, &MavlinkInterface::getTcpData);
 
+    connect(&m_udpLink, &UdpLink::readyRead,
+            this, &MavlinkInterface::getUdpData);
+
     memset(&m_outMessage, 0, sizeof(m_outMessage));
+
+    m_clockSync = new ClockSync(this);
+    subscribe(m_clockSync, ClockSyncMessageIds);
+    connect(this, &MavlinkInterface::connectionChanged,
+            m_clockSync, &ClockSync::handleConnectionChanged);
+
+    m_messageRates = new MessageRates(this);
+    subscribe(m_messageRates, MessageRatesMessageIds);
 }
 
 MavlinkInterface::~MavlinkInterface()
@@ -63,6 +107,11 @@ QVariantList MavlinkInterface::availablePorts() const
 
 bool MavlinkInterface::clear()
 {
+#ifdef Q_OS_LINUX
+    if (m_lowLatencySerial) {
+        return m_nativeSerialPort.clear();
+    }
+#endif
     return m_serialPort.clear();
 }
 
@@ -81,6 +130,11 @@ bool MavlinkInterface::connected() const
 {
     switch (m_interface) {
     case SerialInterface:
+#ifdef Q_OS_LINUX
+        if (m_lowLatencySerial) {
+            return m_nativeSerialPort.isOpen();
+        }
+#endif
         return m_serialPort.isOpen();
         break;
 
@@ -88,6 +142,10 @@ bool MavlinkInterface::connected() const
         return (m_tcpSocket.state()== QTcpSocket::ConnectedState);
         break;
 
+    case UdpInterface:
+        return m_udpLink.isOpen();
+        break;
+
     default:
         break;
     }
@@ -96,12 +154,37 @@ bool MavlinkInterface::connected() const
 
 void MavlinkInterface::getSerialData()
 {
-    parseMavlink(m_serialPort.readAll());
+    if (m_io) {
+        receive(m_io);
+    }
 }
 
 void MavlinkInterface::getTcpData()
 {
-    parseMavlink(m_tcpSocket.readAll());
+    receive(&m_tcpSocket);
+}
+
+void MavlinkInterface::getUdpData()
+{
+    // Datagrams are parsed one by one, a frame never spans two of them
+    int count = 0;
+    while ((count = m_udpLink.receive()) > 0) {
+        const MavlinkParser::Statistics before = m_parser.statistics();
+        qint64 bytes = 0;
+        m_frames.resize(0);
+        for (int i = 0; i < count; ++i) {
+            const UdpLink::Datagram &datagram = m_udpLink.datagram(i);
+            bytes += datagram.size;
+            size_t offset = 0;
+            MavlinkFrame frame;
+            while (m_parser.parse(datagram.data, datagram.size, offset, frame)) {
+                frame.rxTimeNs = datagram.rxTimeNs;
+                m_frames.append(frame);
+            }
+        }
+        countReceived(bytes, before);
+        deliver();
+    }
 }
 
 void MavlinkInterface::pickNextSerial() {
@@ -139,12 +222,40 @@ void MavlinkInterface::pickNextSerial() {
 bool MavlinkInterface::open()
 {
     bool result = false;
+    m_parser.reset();
+    m_rxBuffer.clear();
+    m_byteTimeNs = 0;
+    m_linkCapacity.store(m_interface == SerialInterface ? m_serialRate.toInt() / BitsPerByte : 0,
+                         std::memory_order_relaxed);
     switch (m_interface) {
     case SerialInterface:
-        if (m_serialPort.isOpen()) {
+        if (connected()) {
             close();
         }
         pickNextSerial();
+        if (m_serialRate.toInt() > 0) {
+            m_byteTimeNs = Q_INT64_C(1000000000) * BitsPerByte / m_serialRate.toInt();
+        }
+
+        if (m_lowLatencySerial) {
+#ifdef Q_OS_LINUX
+            m_nativeSerialPort.setPortName(m_usedSerialName);
+            m_nativeSerialPort.setBaudRate(m_serialRate.toInt());
+            m_io = &m_nativeSerialPort;
+            result = m_nativeSerialPort.open(QIODevice::ReadWrite);
+            if (result) {
+                emit connectionChanged();
+            } else {
+                qWarning().noquote() << tr("Warning: Failed to open %1 (%2).")
+                                        .arg(m_usedSerialName)
+                                        .arg(m_nativeSerialPort.errorString());
+            }
+            break;
+#else
+            qWarning().noquote() << tr("Warning: Low-latency serial backend "
+                                       "is only supported on Linux.");
+#endif
+        }
 
         m_serialPort.setPortName(m_usedSerialName);
         m_serialPort.setBaudRate(m_serialRate.toInt());
@@ -170,69 +281,89 @@ bool MavlinkInterface::open()
             emit connectionChanged();
         }
         break;
+
+    case UdpInterface:
+        m_io = &m_udpLink;
+        result = m_udpLink.open(QIODevice::ReadWrite);
+        if (result) {
+            emit connectionChanged();
+        } else {
+            qWarning().noquote() << tr("Warning: Failed to bind UDP port %1 (%2).")
+                                    .arg(m_udpLink.port())
+                                    .arg(m_udpLink.errorString());
+        }
+        break;
     }
 
     return result;
 }
 
-void MavlinkInterface::parseMavlink(const QByteArray &data)
+void MavlinkInterface::reconnect()
 {
-    enum State {
-        IdleState = 0,
-        HeaderState,
-        PayloadState,
-        ChecksumState
-    };
-    static State state = IdleState;
-    static size_t offset = 0;
-    static mavlink_message_t msg;
-    char *header = reinterpret_cast<char *>(&msg.magic);
-    char *payload = reinterpret_cast<char *>(msg.payload64);
-    char *checksum = reinterpret_cast<char *>(&msg.checksum);
-
-    for (int i = 0; i < data.size(); ++i) {
-        const char c = data.at(i);
-        switch (state) {
-        case IdleState:
-            if (c == static_cast<char>(0xFE)) {
-                header[offset++] = c;
-                state = HeaderState;
-            }
-            break;
-        case HeaderState:
-            header[offset++] = c;
-            if (offset >= MAVLINK_NUM_HEADER_BYTES) {
-                offset = 0;
-                state = PayloadState;
-                // TODO: Check msg.seq
-            }
-            break;
-        case PayloadState:
-            payload[offset++] = c;
-            if (offset >= msg.len) {
-                offset = 0;
-                state = ChecksumState;
-            }
-            break;
-        case ChecksumState:
-            checksum[offset++] = c;
-            if (offset >= MAVLINK_NUM_CHECKSUM_BYTES) {
-                offset = 0;
-                state = IdleState;
-
-                // TODO: Add checksum validation
-                emit hasMessage(msg);
-            }
+    close();
+    if (m_timerId == -1) {
+        m_timerId = startTimer(1000);
+    }
+}
+
+void MavlinkInterface::receive(QIODevice *device)
+{
+    for (;;) {
+        m_rxBuffer.reserve(MAVLINK_MAX_PACKET_LEN);
+        const qint64 size =
+                device->read(reinterpret_cast<char *>(m_rxBuffer.writePointer()),
+                             m_rxBuffer.writeSpace());
+        if (size <= 0) {
             break;
         }
+        const qint64 readTime = MonotonicClock::now();
+        m_rxBuffer.commit(size);
+
+        const MavlinkParser::Statistics before = m_parser.statistics();
+        const quint8 *end = m_rxBuffer.readPointer() + m_rxBuffer.readSize();
+        size_t offset = 0;
+        MavlinkFrame frame;
+        m_frames.resize(0);
+        while (m_parser.parse(m_rxBuffer.readPointer(), m_rxBuffer.readSize(),
+                              offset, frame)) {
+            const qint64 bytesAfter = end - (frame.data + frame.size());
+            frame.rxTimeNs = readTime - bytesAfter * m_byteTimeNs;
+            m_frames.append(frame);
+        }
+        countReceived(size, before);
+        deliver();
+        m_rxBuffer.consume(offset);
     }
 }
 
-void MavlinkInterface::reconnect()
+void MavlinkInterface::countReceived(qint64 bytes, const MavlinkParser::Statistics &before)
 {
-    close();
-    if (m_timerId == -1) {
-        m_timerId = startTimer(1000);
+    const MavlinkParser::Statistics &after = m_parser.statistics();
+    m_receivedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_receivedFrames.fetch_add(after.goodFrames - before.goodFrames
+                               + after.filteredFrames - before.filteredFrames,
+                               std::memory_order_relaxed);
+    m_lostFrames.fetch_add(after.lostFrames - before.lostFrames,
+                           std::memory_order_relaxed);
+}
+
+void MavlinkInterface::deliver()
+{
+    if (m_frames.isEmpty()) {
+        return;
+    }
+    for (Subscription &subscription : m_subscriptions) {
+        // resize(0) keeps the capacity, so batches don't allocate
+        subscription.frames.resize(0);
+        for (const MavlinkFrame &frame : m_frames) {
+            if (subscription.ids.test(frame.msgid())) {
+                subscription.frames.append(frame);
+            }
+        }
+        if (!subscription.frames.isEmpty()) {
+            subscription.consumer->handleFrames(subscription.frames.constData(),
+                                                subscription.frames.size());
+        }
     }
 }
 
@@ -245,6 +376,43 @@ bool MavlinkInterface::tryAnotherSerialInterface() {
     return result;
 }
 
+void MavlinkInterface::subscribe(MavlinkConsumer *consumer,
+                                 const MavlinkMessageIds &ids)
+{
+    for (Subscription &subscription : m_subscriptions) {
+        if (subscription.consumer == consumer) {
+            subscription.ids = ids;
+            updateMessageFilter();
+            return;
+        }
+    }
+    Subscription subscription;
+    subscription.consumer = consumer;
+    subscription.ids = ids;
+    m_subscriptions.append(subscription);
+    updateMessageFilter();
+}
+
+void MavlinkInterface::unsubscribe(MavlinkConsumer *consumer)
+{
+    for (int i = 0; i < m_subscriptions.size(); ++i) {
+        if (m_subscriptions.at(i).consumer == consumer) {
+            m_subscriptions.remove(i);
+            updateMessageFilter();
+            return;
+        }
+    }
+}
+
+void MavlinkInterface::updateMessageFilter()
+{
+    MavlinkMessageIds ids;
+    for (const Subscription &subscription : m_subscriptions) {
+        ids = ids | subscription.ids;
+    }
+    m_parser.setMessageFilter(ids);
+}
+
 bool MavlinkInterface::sendMessage(const mavlink_message_t &message)
 {
     if(!message.len) {
@@ -33,18 +33,55 @@
 #include <QSerialPort>
 #include <QTcpSocket>
 #include <QVariant>
+#include <QVector>
+
+#include <atomic>
 
 #include <mavlink_types.h>
 
+#ifdef Q_OS_LINUX
+#include "linux_serial_port.h"
+#endif
+#include "mavlink_message_ids.h"
+#include "mavlink_parser.h"
+#include "rx_buffer.h"
+#include "udp_link.h"
+
 Q_DECLARE_METATYPE(mavlink_message_t)
 
+class ClockSync;
+class MessageRates;
+
 namespace C {
 const int SystemId = 1;
 const int ComponentId = 1;
 }
 
 /**
- * @brief The abstraction to interface with MAVLink IMU via serial or TCP
+ * @brief Receiver of decoded MAVLink frames
+ *
+ * Consumers are called directly from the thread reading the link, once per
+ * device read, with all frames of the read matching their subscription.
+ */
+class MavlinkConsumer
+{
+public:
+    virtual ~MavlinkConsumer() {}
+
+    /**
+     * @brief Handle a batch of decoded frames
+     *
+     * The frames point into the interface receive buffer and are only valid
+     * during the call.
+     *
+     * @param frames frames in the order of reception
+     * @param count number of frames
+     */
+    virtual void handleFrames(const MavlinkFrame *frames, int count) = 0;
+};
+
+/**
+ * @brief The abstraction to interface with MAVLink IMU via serial, TCP or UDP
  */
 class MavlinkInterface : public QObject
 {
@@ -53,13 +90,16 @@ class MavlinkInterface : public QObject
     Q_PROPERTY(bool connected READ connected NOTIFY connectionChanged)
     Q_PROPERTY(QString serialName READ serialName WRITE setSerialName)
     Q_PROPERTY(QString serialRate READ serialRate WRITE setSerialRate)
+    Q_PROPERTY(bool lowLatencySerial READ lowLatencySerial WRITE setLowLatencySerial)
     Q_PROPERTY(QString tcpAddress READ tcpAddress WRITE setTcpAddress)
     Q_PROPERTY(quint16 tcpPort READ tcpPort WRITE setTcpPort)
+    Q_PROPERTY(quint16 udpPort READ udpPort WRITE setUdpPort)
 
 public:
     enum Interface {
         SerialInterface = 0,
-        TcpInterface
+        TcpInterface,
+        UdpInterface
     };
 
     MavlinkInterface(QObject *parent = Q_NULLPTR);
@@ -85,6 +125,10 @@ public:
      * @brief Use TCP as primary interface for all future actions
      */
     Q_INVOKABLE void setTcpInterface() { m_interface = TcpInterface; }
+    /**
+     * @brief Use UDP as primary interface for all future actions
+     */
+    Q_INVOKABLE void setUdpInterface() { m_interface = UdpInterface; }
 
     /**
      * @brief Get the regex for serial interface name
@@ -113,6 +157,20 @@ public:
      */
     void setSerialRate(const QString &serialRate) { m_serialRate = serialRate; }
 
+    /**
+     * @brief Check whether the low-latency native serial backend is used
+     * @return true if serial ports are opened with LinuxSerialPort
+     */
+    bool lowLatencySerial() const { return m_lowLatencySerial; }
+    /**
+     * @brief Use the low-latency native serial backend instead of QSerialPort
+     *
+     * Only supported on Linux, takes effect on the next open().
+     *
+     * @param lowLatencySerial true to use LinuxSerialPort
+     */
+    void setLowLatencySerial(bool lowLatencySerial) { m_lowLatencySerial = lowLatencySerial; }
+
     /**
      * @brief Get IP address used for TCP communication with a MAVLink device
      * @return String representation of an IP address
@@ -135,6 +193,24 @@ public:
      */
     void setTcpPort(const quint16 &tcpPort) { m_tcpPort = tcpPort; }
 
+    /**
+     * @brief Get local UDP port MAVLink datagrams are received on
+     * @return UDP port
+     */
+    quint16 udpPort() const { return m_udpLink.port(); }
+    /**
+     * @brief Set local UDP port to receive MAVLink datagrams on
+     * @param udpPort port to listen on
+     */
+    void setUdpPort(quint16 udpPort) { m_udpLink.setPort(udpPort); }
+    /**
+     * @brief Accept MAVLink datagrams only from given hosts
+     * @param senders allowed sender addresses, empty to accept everyone
+     */
+    void setUdpAllowedSenders(const QList<QHostAddress> &senders) {
+        m_udpLink.setAllowedSenders(senders);
+    }
+
     /**
      * @brief Get available serial ports
      * @return List of available ports (represented by QStrings)
@@ -168,13 +244,77 @@ public:
      *
      * @return true if interfaces changed successfully and new one is open
      */
-    bool tryAnotherSerialInterface();
+    Q_INVOKABLE bool tryAnotherSerialInterface();
     /**
      * @brief Send MAVLink message
      * @param message MAVLink message to send
      * @return true if the message was written to an IO buffer, false otherwise
      */
-    bool sendMessage(const mavlink_message_t &message);
+    Q_INVOKABLE bool sendMessage(const mavlink_message_t &message);
+
+    /**
+     * @brief Subscribe a consumer to incoming frames
+     *
+     * Frames are filtered by message ID before delivery, so the consumer
+     * only gets messages from @p ids. Subscribing the same consumer again
+     * replaces its filter. Messages no consumer is subscribed to are dropped
+     * by the parser right after their header is read.
+     *
+     * @param consumer consumer to deliver frames to
+     * @param ids message IDs the consumer wants to get
+     */
+    void subscribe(MavlinkConsumer *consumer, const MavlinkMessageIds &ids);
+    /**
+     * @brief Stop delivering frames to a consumer
+     * @param consumer consumer to remove
+     */
+    void unsubscribe(MavlinkConsumer *consumer);
+
+    /**
+     * @brief Get the synchronisation of the autopilot clock to the host one
+     *
+     * Must only be used on the thread of the interface.
+     *
+     * @return Clock synchronisation
+     */
+    ClockSync *clockSync() const { return m_clockSync; }
+    /**
+     * @brief Get the requests of MAVLink messages at their rates
+     * @return Message rate requests
+     */
+    MessageRates *messageRates() const { return m_messageRates; }
+
+    /**
+     * @brief Get the capacity of the link, may be called from any thread
+     *
+     * Known for serial links only, updated when the link is opened.
+     *
+     * @return Bytes per second, 0 if unknown
+     */
+    qint64 linkCapacity() const { return m_linkCapacity.load(std::memory_order_relaxed); }
+    /**
+     * @brief Get the number of bytes received, may be called from any thread
+     * @return Bytes received since the interface was created
+     */
+    quint64 receivedBytes() const { return m_receivedBytes.load(std::memory_order_relaxed); }
+    /**
+     * @brief Get the number of good frames, may be called from any thread
+     * @return Frames received since the interface was created
+     */
+    quint64 receivedFrames() const { return m_receivedFrames.load(std::memory_order_relaxed); }
+    /**
+     * @brief Get the number of lost frames, may be called from any thread
+     * @return Frames missing according to sequence numbers since the interface was created
+     */
+    quint64 lostFrames() const { return m_lostFrames.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the counters of the incoming frame parser
+     * @return Parser counters since the interface was last opened
+     */
+    const MavlinkParser::Statistics &parserStatistics() const {
+        return m_parser.statistics();
+    }
 
 protected:
     /**
@@ -189,11 +329,6 @@ signals:
      */
     void connectionChanged();
 
-    /**
-     * @brief Emitted on MAVLink packet receive
-     * @param msg received MAVLink packet
-     */
-    void hasMessage(const mavlink_message_t &msg);
 
 private slots:
     /**
@@ -206,6 +341,11 @@ private slots:
      */
     void getTcpData();
 
+    /**
+     * @brief Get new MAVLink datagrams from a UDP interface
+     */
+    void getUdpData();
+
     /**
      * @brief Set timer for reconnection in case of a disconnection
      */
@@ -213,10 +353,29 @@ private slots:
 
 private:
     /**
-     * @brief Parse incoming MAVLink data
-     * @param data incoming raw MAVLink data to parse
+     * @brief Read and parse all pending MAVLink data of a device
+     *
+     * Every read chunk is stamped with the monotonic clock right after the
+     * read. On serial links the time of each frame is then interpolated
+     * back from the chunk time by the number of bytes which followed it.
+     *
+     * @param device device to read from
+     */
+    void receive(QIODevice *device);
+    /**
+     * @brief Add one read to the link statistics
+     * @param bytes number of bytes read
+     * @param before parser statistics before the read was parsed
      */
-    void parseMavlink(const QByteArray &data);
+    void countReceived(qint64 bytes, const MavlinkParser::Statistics &before);
+    /**
+     * @brief Deliver frames of one read to the subscribed consumers
+     */
+    void deliver();
+    /**
+     * @brief Let the parser drop messages no consumer is subscribed to
+     */
+    void updateMessageFilter();
     bool sendMessage() { return sendMessage(m_outMessage); }
 
     /**
@@ -241,6 +400,10 @@ private:
      * @brief Serial interface rate in bauds per second
      */
     QString m_serialRate = "57600";
+    /**
+     * @brief Whether to use the native low-latency serial backend
+     */
+    bool m_lowLatencySerial = false;
     /**
      * @brief IP address for TCP connection
      */
@@ -254,12 +417,22 @@ private:
      * @brief Serial port to use for MAVLink data exchange
      */
     QSerialPort m_serialPort;
+#ifdef Q_OS_LINUX
+    /**
+     * @brief Low-latency serial port used instead of m_serialPort
+     */
+    LinuxSerialPort m_nativeSerialPort;
+#endif
     /**
      * @brief TCP socket to use for MAVLink data exchange
      */
     QTcpSocket m_tcpSocket;
     /**
-     * @brief Pointer to m_serialPort or m_tcpSocket
+     * @brief UDP endpoint to use for MAVLink data exchange
+     */
+    UdpLink m_udpLink;
+    /**
+     * @brief Pointer to the serial port in use, m_tcpSocket or m_udpLink
      */
     QIODevice *m_io = Q_NULLPTR;
     /**
@@ -271,6 +444,55 @@ private:
      * @brief Outgoing MAVLink message to be sent
      */
     mavlink_message_t m_outMessage;
+
+    /**
+     * @brief Parser of the incoming MAVLink stream
+     */
+    MavlinkParser m_parser;
+    /**
+     * @brief Buffer the incoming MAVLink stream is read and parsed in
+     */
+    RxBuffer m_rxBuffer;
+
+    /**
+     * @brief Synchronisation of the autopilot clock, owned by the interface
+     */
+    ClockSync *m_clockSync = Q_NULLPTR;
+    /**
+     * @brief Message rate requests, owned by the interface
+     */
+    MessageRates *m_messageRates = Q_NULLPTR;
+
+    /**
+     * @brief Consumer subscription with its delivery batch
+     */
+    struct Subscription {
+        MavlinkConsumer *consumer;
+        MavlinkMessageIds ids;
+        QVector<MavlinkFrame> frames;
+    };
+    /**
+     * @brief Consumers of incoming frames
+     */
+    QVector<Subscription> m_subscriptions;
+    /**
+     * @brief Frames decoded from the current read
+     */
+    QVector<MavlinkFrame> m_frames;
+    /**
+     * @brief Time to transfer one byte over the link (ns), 0 if unknown
+     *
+     * Used to estimate when each frame of a read chunk was received.
+     */
+    qint64 m_byteTimeNs = 0;
+
+    /**
+     * @brief Link counters published for other threads
+     */
+    std::atomic<quint64> m_receivedBytes;
+    std::atomic<quint64> m_receivedFrames;
+    std::atomic<quint64> m_lostFrames;
+    std::atomic<qint64> m_linkCapacity;
 };
 
 #endif // #ifndef MAVLINK_INTERFACE_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file mavlink_message_ids.h
+ * @brief File contains a set of MAVLink message IDs
+ */
+
+#ifndef MAVLINK_MESSAGE_IDS_H
+#define MAVLINK_MESSAGE_IDS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Set of MAVLink 1.0 message IDs
+ *
+ * A 256-bit mask, usually built once with mavlinkMessageIds(), so that
+ * testing whether a message is wanted costs a single bit test.
+ */
+class MavlinkMessageIds
+{
+public:
+    /**
+     * @brief Construct an empty set
+     */
+    MavlinkMessageIds() { clear(0); }
+
+    /**
+     * @brief Get a set containing every message ID
+     * @return Full set
+     */
+    static MavlinkMessageIds all() {
+        MavlinkMessageIds ids;
+        ids.clear(~0ULL);
+        return ids;
+    }
+
+    /**
+     * @brief Check whether the set contains a message ID
+     * @param id message ID
+     * @return true if @p id is in the set
+     */
+    bool test(quint8 id) const {
+        return (m_words[id >> 6] >> (id & 63)) & 1;
+    }
+
+    /**
+     * @brief Add a message ID to the set
+     * @param id message ID
+     */
+    void set(quint8 id) { m_words[id >> 6] |= 1ULL << (id & 63); }
+
+    /**
+     * @brief Get the union of two sets
+     * @param other set to unite with
+     * @return Set with IDs of both sets
+     */
+    MavlinkMessageIds operator|(const MavlinkMessageIds &other) const {
+        MavlinkMessageIds ids;
+        for (int i = 0; i < 4; ++i) {
+            ids.m_words[i] = m_words[i] | other.m_words[i];
+        }
+        return ids;
+    }
+
+private:
+    /**
+     * @brief Set all mask words
+     * @param word value of every word
+     */
+    void clear(quint64 word) {
+        for (int i = 0; i < 4; ++i) {
+            m_words[i] = word;
+        }
+    }
+
+    quint64 m_words[4];
+};
+
+namespace MavlinkMessageIdsDetail {
+
+inline void add(MavlinkMessageIds & /*ids*/)
+{
+}
+
+template <typename... Rest>
+void add(MavlinkMessageIds &ids, quint8 id, Rest... rest)
+{
+    ids.set(id);
+    add(ids, rest...);
+}
+
+} // namespace MavlinkMessageIdsDetail
+
+/**
+ * @brief Build a set of message IDs
+ *
+ * @code
+ * const MavlinkMessageIds ids =
+ *         mavlinkMessageIds<MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_ATTITUDE>();
+ * @endcode
+ *
+ * @return Set of the given IDs
+ */
+template <quint8... Ids>
+MavlinkMessageIds mavlinkMessageIds()
+{
+    MavlinkMessageIds ids;
+    MavlinkMessageIdsDetail::add(ids, Ids...);
+    return ids;
+}
+
+#endif // #ifndef MAVLINK_MESSAGE_IDS_H
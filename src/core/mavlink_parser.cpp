@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "mavlink_parser.h"
+#include "x25_crc.h"
+
+#include <common/mavlink.h>
+
+namespace {
+const quint8 MessageLengths[256] = MAVLINK_MESSAGE_LENGTHS;
+const quint8 MessageCrcs[256] = MAVLINK_MESSAGE_CRCS;
+}
+
+void MavlinkParser::reset()
+{
+    m_skipping = false;
+    m_senderCount = 0;
+    m_statistics = Statistics();
+}
+
+bool MavlinkParser::parse(const quint8 *data, size_t size, size_t &offset,
+                          MavlinkFrame &frame)
+{
+    while (offset < size) {
+        const quint8 *start = data + offset;
+        const size_t available = size - offset;
+
+        if (start[0] != MAVLINK_STX) {
+            // Jump over the garbage in bulk, memchr() is vectorized by libc
+            skip();
+            const void *stx = memchr(start, MAVLINK_STX, available);
+            offset = stx ? static_cast<const quint8 *>(stx) - data : size;
+            continue;
+        }
+        if (available < MAVLINK_NUM_HEADER_BYTES) {
+            return false;
+        }
+
+        // Cheap candidate check before waiting for the whole frame:
+        // unknown messages have zero length in the table
+        const quint8 len = start[1];
+        const quint8 msgid = start[5];
+        const quint8 expected = MessageLengths[msgid];
+        if (expected == 0 || len != expected) {
+            m_statistics.badLengthFrames++;
+            skip();
+            offset++;
+            continue;
+        }
+
+        const size_t frameSize = len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        if (available < frameSize) {
+            return false;
+        }
+
+        MavlinkFrame candidate;
+        candidate.data = start;
+        const bool wanted = m_filter.test(msgid);
+        if (!wanted && inSequence(candidate)) {
+            m_skipping = false;
+            m_statistics.filteredFrames++;
+            updateSequence(candidate);
+            offset += frameSize;
+            continue;
+        }
+
+        quint16 crc = X25Crc::calculate(start + 1,
+                                        MAVLINK_CORE_HEADER_LEN + len);
+        crc = X25Crc::accumulate(crc, MessageCrcs[msgid]);
+        const quint8 *checksum = start + MAVLINK_NUM_HEADER_BYTES + len;
+        if (checksum[0] != (crc & 0xff) || checksum[1] != (crc >> 8)) {
+            // Rescan from the next byte, a real frame may start inside
+            m_statistics.badCrcFrames++;
+            skip();
+            offset++;
+            continue;
+        }
+
+        m_skipping = false;
+        updateSequence(candidate);
+        offset += frameSize;
+        if (!wanted) {
+            m_statistics.filteredFrames++;
+            continue;
+        }
+        m_statistics.goodFrames++;
+        frame = candidate;
+        return true;
+    }
+    return false;
+}
+
+void MavlinkParser::skip()
+{
+    if (!m_skipping) {
+        m_skipping = true;
+        m_statistics.resyncs++;
+    }
+}
+
+bool MavlinkParser::inSequence(const MavlinkFrame &frame) const
+{
+    for (int i = 0; i < m_senderCount; ++i) {
+        const Sender &sender = m_senders[i];
+        if (sender.sysid == frame.sysid() && sender.compid == frame.compid()) {
+            return static_cast<quint8>(sender.seq + 1) == frame.seq();
+        }
+    }
+    return false;
+}
+
+void MavlinkParser::updateSequence(const MavlinkFrame &frame)
+{
+    for (int i = 0; i < m_senderCount; ++i) {
+        Sender &sender = m_senders[i];
+        if (sender.sysid == frame.sysid() && sender.compid == frame.compid()) {
+            const quint8 gap = frame.seq() - static_cast<quint8>(sender.seq + 1);
+            m_statistics.lostFrames += gap;
+            sender.seq = frame.seq();
+            return;
+        }
+    }
+    if (m_senderCount < MaxSenders) {
+        Sender &sender = m_senders[m_senderCount++];
+        sender.sysid = frame.sysid();
+        sender.compid = frame.compid();
+        sender.seq = frame.seq();
+    }
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file mavlink_parser.h
+ * @brief File contains a declaration of the MAVLink frame parser - MavlinkParser
+ */
+
+#ifndef MAVLINK_PARSER_H
+#define MAVLINK_PARSER_H
+
+#include <QtGlobal>
+
+#include <string.h>
+
+#include <mavlink_types.h>
+
+#include "mavlink_message_ids.h"
+
+/**
+ * @brief Read-only view of a validated MAVLink frame
+ *
+ * The view points directly into the receive buffer of a link and is only
+ * valid until the link reads more data, i.e. for the duration of the call
+ * or signal emission it was passed to.
+ */
+struct MavlinkFrame
+{
+    /**
+     * @brief Frame start (STX byte)
+     */
+    const quint8 *data = Q_NULLPTR;
+    /**
+     * @brief Host monotonic time the last frame byte was received (ns)
+     *
+     * Filled in by the link, see MonotonicClock.
+     */
+    qint64 rxTimeNs = 0;
+
+    quint8 len() const { return data[1]; }
+    quint8 seq() const { return data[2]; }
+    quint8 sysid() const { return data[3]; }
+    quint8 compid() const { return data[4]; }
+    quint8 msgid() const { return data[5]; }
+
+    /**
+     * @brief Get the message payload
+     * @return Pointer to len() payload bytes
+     */
+    const quint8 *payload() const { return data + MAVLINK_NUM_HEADER_BYTES; }
+
+    /**
+     * @brief Get the size of the whole frame on the wire
+     * @return Frame size including header and checksum
+     */
+    size_t size() const { return len() + MAVLINK_NUM_NON_PAYLOAD_BYTES; }
+
+    /**
+     * @brief Decode the payload into a message structure
+     *
+     * Equivalent of the generated mavlink_msg_*_decode() functions for a
+     * little-endian host.
+     *
+     * @param packet message structure to fill (e.g. mavlink_attitude_t)
+     */
+    template <typename T>
+    void decode(T *packet) const
+    {
+        const size_t length = qMin(static_cast<size_t>(len()), sizeof(T));
+        memset(packet, 0, sizeof(T));
+        memcpy(packet, payload(), length);
+    }
+};
+
+/**
+ * @brief In-place MAVLink 1.0 frame parser
+ *
+ * The parser decodes frames directly from a caller-owned buffer and never
+ * copies them. Every parser instance keeps its own state, so several links
+ * may be parsed in one process. A frame is only reported when its length
+ * matches the one expected for its message ID and its X.25 checksum (seeded
+ * with CRC_EXTRA) is valid. Frames of unknown messages are rejected as well
+ * since there is no CRC_EXTRA to validate them with.
+ *
+ * Garbage between frames is skipped in bulk up to the next STX byte, and
+ * every candidate start is checked against the expected message length
+ * before the parser waits for the rest of the frame. Resynchronisation time
+ * therefore depends on the number of candidate starts, not on the amount of
+ * noise.
+ *
+ * Frames of messages outside of the message filter are dropped right after
+ * the header. If the frame continues the sequence of its sender, the framing
+ * is trusted and the frame is skipped without computing its checksum.
+ */
+class MavlinkParser
+{
+public:
+    /**
+     * @brief Per-link parser counters
+     */
+    struct Statistics {
+        /**
+         * @brief Frames which passed length and checksum validation
+         */
+        quint64 goodFrames = 0;
+        /**
+         * @brief Frames dropped because of a checksum mismatch
+         */
+        quint64 badCrcFrames = 0;
+        /**
+         * @brief Frames dropped because of an unknown ID or wrong length
+         */
+        quint64 badLengthFrames = 0;
+        /**
+         * @brief Number of times the parser had to look for a new frame start
+         *
+         * Counted once per run of skipped garbage bytes.
+         */
+        quint64 resyncs = 0;
+        /**
+         * @brief Frames dropped by the message filter
+         */
+        quint64 filteredFrames = 0;
+        /**
+         * @brief Frames missing according to sender sequence numbers
+         */
+        quint64 lostFrames = 0;
+    };
+
+    /**
+     * @brief Reset the parser state and counters
+     */
+    void reset();
+
+    /**
+     * @brief Set the messages to report
+     *
+     * All messages are reported by default.
+     *
+     * @param ids IDs of messages to report, others are dropped
+     */
+    void setMessageFilter(const MavlinkMessageIds &ids) { m_filter = ids; }
+
+    /**
+     * @brief Find the next valid frame in a buffer
+     *
+     * Scans the buffer from @p offset. If a valid frame is found, @p frame
+     * is set to point at it and @p offset is moved past it. Otherwise
+     * @p offset is left at the first byte which may still start a frame,
+     * everything before it can be discarded by the caller.
+     *
+     * @param data buffer with raw MAVLink stream
+     * @param size number of bytes in the buffer
+     * @param offset position to start scanning from, updated on return
+     * @param frame receives the frame view on success
+     * @return true if a frame was found, false if more data is needed
+     */
+    bool parse(const quint8 *data, size_t size, size_t &offset,
+               MavlinkFrame &frame);
+
+    /**
+     * @brief Get the parser counters
+     * @return Counters accumulated since the last reset()
+     */
+    const Statistics &statistics() const { return m_statistics; }
+
+private:
+    /**
+     * @brief Account for a byte which does not start a valid frame
+     */
+    void skip();
+
+    /**
+     * @brief Check that a frame continues the sequence of its sender
+     * @param frame frame to check
+     * @return true if the frame has the expected sequence number
+     */
+    bool inSequence(const MavlinkFrame &frame) const;
+
+    /**
+     * @brief Remember the sequence number of a valid frame
+     *
+     * Gaps in the sequence are counted as lost frames.
+     *
+     * @param frame valid frame
+     */
+    void updateSequence(const MavlinkFrame &frame);
+
+private:
+    /**
+     * @brief Last sequence number seen from a sender
+     */
+    struct Sender {
+        quint8 sysid;
+        quint8 compid;
+        quint8 seq;
+    };
+    /**
+     * @brief Maximal number of senders tracked per link
+     */
+    static const int MaxSenders = 8;
+
+    /**
+     * @brief Messages to report
+     */
+    MavlinkMessageIds m_filter = MavlinkMessageIds::all();
+    /**
+     * @brief Senders seen on the link
+     */
+    Sender m_senders[MaxSenders];
+    /**
+     * @brief Number of valid entries in m_senders
+     */
+    int m_senderCount = 0;
+    /**
+     * @brief Whether garbage bytes are being skipped at the moment
+     */
+    bool m_skipping = false;
+    /**
+     * @brief Parser counters
+     */
+    Statistics m_statistics;
+};
+
+#endif // #ifndef MAVLINK_PARSER_H
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "message_rates.h"
+
+#include <QDebug>
+#include <QtMath>
+
+#include <common/mavlink.h>
+
+MessageRates::MessageRates(MavlinkInterface *mavlinkInterface) :
+    QObject(mavlinkInterface), m_mavlinkInterface(mavlinkInterface), m_timer(this)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &MessageRates::handleTimeout);
+}
+
+void MessageRates::setRate(quint8 msgid, float rate, int fallbackStream)
+{
+    for (int i = 0; i < m_rates.size(); ++i) {
+        if (m_rates[i].msgid == msgid) {
+            m_rates.remove(i);
+            break;
+        }
+    }
+    if (rate > 0) {
+        Rate wanted;
+        wanted.msgid = msgid;
+        wanted.rate = rate;
+        wanted.fallbackStream = fallbackStream;
+        m_rates.append(wanted);
+    }
+}
+
+void MessageRates::updateRate(int msgid, float rate)
+{
+    for (Rate &wanted : m_rates) {
+        if (wanted.msgid == msgid) {
+            wanted.rate = rate;
+            request();
+            return;
+        }
+    }
+}
+
+void MessageRates::handleFrames(const MavlinkFrame *frames, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const MavlinkFrame &frame = frames[i];
+        if (frame.msgid() == MAVLINK_MSG_ID_HEARTBEAT) {
+            mavlink_heartbeat_t packet;
+            frame.decode(&packet);
+            // Ground stations on the same link send heartbeats too
+            if (packet.autopilot != MAV_AUTOPILOT_INVALID) {
+                m_targetSystem = frame.sysid();
+                m_targetComponent = frame.compid();
+            }
+        } else if (frame.msgid() == MAVLINK_MSG_ID_COMMAND_ACK && m_current >= 0) {
+            mavlink_command_ack_t packet;
+            frame.decode(&packet);
+            if (packet.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+                m_timer.stop();
+                next(packet.result == MAV_RESULT_ACCEPTED);
+            }
+        }
+    }
+}
+
+void MessageRates::request()
+{
+    m_timer.stop();
+    m_fallbacks.clear();
+    m_current = -1;
+    next(true);
+}
+
+void MessageRates::handleTimeout()
+{
+    if (m_attempts < MaxAttempts) {
+        sendCommand();
+    } else {
+        next(false);
+    }
+}
+
+void MessageRates::sendCommand()
+{
+    const Rate &wanted = m_rates[m_current];
+
+    mavlink_command_long_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.target_system = m_targetSystem;
+    packet.target_component = m_targetComponent;
+    packet.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    packet.confirmation = static_cast<quint8>(m_attempts);
+    packet.param1 = wanted.msgid;
+    packet.param2 = 1e6f / wanted.rate;
+
+    mavlink_message_t message;
+    mavlink_msg_command_long_encode(C::SystemId, MAV_COMP_ID_SYSTEM_CONTROL,
+                                    &message, &packet);
+    m_mavlinkInterface->sendMessage(message);
+    m_attempts++;
+    m_timer.start(AckTimeout);
+}
+
+void MessageRates::next(bool accepted)
+{
+    if (m_current >= 0 && !accepted) {
+        const Rate &refused = m_rates[m_current];
+        qWarning().noquote() << tr("Warning: Autopilot didn't accept the interval of message %1%2.")
+                                .arg(refused.msgid)
+                                .arg(refused.fallbackStream >= 0
+                                     ? tr(", requesting data stream %1").arg(refused.fallbackStream)
+                                     : QString());
+        if (refused.fallbackStream >= 0) {
+            m_fallbacks.append(refused);
+        }
+    }
+
+    m_current++;
+    m_attempts = 0;
+    if (m_current < m_rates.size()) {
+        sendCommand();
+        return;
+    }
+    m_current = -1;
+
+    // One request per stream, at the highest rate wanted from it
+    for (int i = 0; i < m_fallbacks.size(); ++i) {
+        float rate = m_fallbacks[i].rate;
+        bool first = true;
+        for (int j = 0; j < m_fallbacks.size(); ++j) {
+            if (m_fallbacks[j].fallbackStream == m_fallbacks[i].fallbackStream) {
+                first = first && j >= i;
+                rate = qMax(rate, m_fallbacks[j].rate);
+            }
+        }
+        if (first) {
+            requestDataStream(m_fallbacks[i].fallbackStream, static_cast<quint16>(qCeil(rate)));
+        }
+    }
+    m_fallbacks.clear();
+}
+
+void MessageRates::requestDataStream(int stream, quint16 rate)
+{
+    mavlink_request_data_stream_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.target_system = m_targetSystem;
+    packet.target_component = m_targetComponent;
+    packet.req_stream_id = static_cast<quint8>(stream);
+    packet.req_message_rate = rate;
+    packet.start_stop = 1; // start
+
+    mavlink_message_t message;
+    mavlink_msg_request_data_stream_encode(C::SystemId,
+                                           MAV_COMP_ID_SYSTEM_CONTROL,
+                                           &message,
+                                           &packet);
+    m_mavlinkInterface->sendMessage(message);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file message_rates.h
+ * @brief File contains a declaration of the MAVLink message rate negotiation - MessageRates
+ */
+
+#ifndef MESSAGE_RATES_H
+#define MESSAGE_RATES_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "mavlink_interface.h"
+
+/**
+ * @brief Requests of the MAVLink messages the feeder needs at their rates
+ *
+ * Every message is requested on its own with MAV_CMD_SET_MESSAGE_INTERVAL.
+ * Commands are sent one at a time, since COMMAND_ACK doesn't tell which
+ * message it answers, and repeated if no COMMAND_ACK arrives. Messages the
+ * autopilot refuses or doesn't acknowledge are requested with the
+ * REQUEST_DATA_STREAM group containing them instead, at the highest rate
+ * wanted from the group.
+ *
+ * Commands are addressed to the autopilot seen in HEARTBEAT messages.
+ * request() must be called again after the autopilot was lost, so it
+ * restores the rates after a reboot.
+ *
+ * MessageRates belongs to a MavlinkInterface and runs on its thread.
+ */
+class MessageRates : public QObject, public MavlinkConsumer
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Time to wait for a COMMAND_ACK (ms)
+     */
+    static const int AckTimeout = 1000;
+    /**
+     * @brief Number of times a command is sent before falling back
+     */
+    static const int MaxAttempts = 3;
+
+    /**
+     * @brief Create the message rate requests of an interface
+     * @param mavlinkInterface interface to send the requests over
+     */
+    explicit MessageRates(MavlinkInterface *mavlinkInterface);
+
+    /**
+     * @brief Set the rate of a message
+     *
+     * Takes effect on the next request().
+     *
+     * @param msgid MAVLink message ID
+     * @param rate wanted rate (Hz), 0 to not request the message
+     * @param fallbackStream MAV_DATA_STREAM containing the message, -1 if none
+     */
+    void setRate(quint8 msgid, float rate, int fallbackStream = -1);
+
+    /**
+     * @brief Handle HEARTBEAT and COMMAND_ACK frames
+     * @param frames frames to handle
+     * @param count number of frames
+     */
+    void handleFrames(const MavlinkFrame *frames, int count) Q_DECL_OVERRIDE;
+
+public slots:
+    /**
+     * @brief Change the rate of a message and request all messages again
+     * @param msgid MAVLink message ID, set with setRate() before
+     * @param rate new rate (Hz)
+     */
+    void updateRate(int msgid, float rate);
+    /**
+     * @brief Request all messages at their rates
+     *
+     * Restarts the requests if they are in progress.
+     */
+    void request();
+
+private slots:
+    /**
+     * @brief Repeat the current command or fall back if it is unanswered
+     */
+    void handleTimeout();
+
+private:
+    /**
+     * @brief Wanted message
+     */
+    struct Rate
+    {
+        quint8 msgid;
+        float rate;
+        int fallbackStream;
+    };
+
+    /**
+     * @brief Send MAV_CMD_SET_MESSAGE_INTERVAL for the current message
+     */
+    void sendCommand();
+    /**
+     * @brief Finish the current message and request the next one
+     * @param accepted whether the autopilot accepted the command
+     */
+    void next(bool accepted);
+    /**
+     * @brief Send REQUEST_DATA_STREAM
+     * @param stream MAVLink data stream to use
+     * @param rate requested message rate
+     */
+    void requestDataStream(int stream, quint16 rate);
+
+private:
+    /**
+     * @brief Interface to send the requests over
+     */
+    MavlinkInterface *m_mavlinkInterface;
+    /**
+     * @brief COMMAND_ACK timeout timer
+     */
+    QTimer m_timer;
+    /**
+     * @brief Wanted messages
+     */
+    QVector<Rate> m_rates;
+    /**
+     * @brief Index of the message being requested, -1 if none
+     */
+    int m_current = -1;
+    /**
+     * @brief Number of times the current command was sent
+     */
+    int m_attempts = 0;
+    /**
+     * @brief Messages requested by data streams in the current pass
+     */
+    QVector<Rate> m_fallbacks;
+    /**
+     * @brief Autopilot system and component ID, 0 until a HEARTBEAT arrives
+     */
+    quint8 m_targetSystem = 0;
+    quint8 m_targetComponent = 0;
+};
+
+#endif // #ifndef MESSAGE_RATES_H
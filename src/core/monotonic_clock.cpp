@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "monotonic_clock.h"
+
+#include <chrono>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef Q_OS_WIN
+namespace {
+
+qint64 performanceFrequency()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+
+// Set during static initialisation: function-local statics are not
+// thread-safe with MSVC 2013
+const qint64 PerformanceFrequency = performanceFrequency();
+
+} // namespace
+#endif
+
+qint64 MonotonicClock::now()
+{
+    // std::chrono::steady_clock is system_clock on MSVC 2013: it jumps with
+    // the wall clock and ticks every 15.6 ms
+#ifdef Q_OS_WIN
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const qint64 seconds = counter.QuadPart / PerformanceFrequency;
+    const qint64 rest = counter.QuadPart % PerformanceFrequency;
+    return seconds * 1000000000 + rest * 1000000000 / PerformanceFrequency;
+#else
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
+qint64 MonotonicClock::systemOffset()
+{
+#ifdef Q_OS_WIN
+    const qint64 system = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+#else
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    const qint64 system = qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+    return system - now();
+}
+
+qint64 MonotonicClock::fromSystemTime(qint64 systemNs)
+{
+    return systemNs - systemOffset();
+}
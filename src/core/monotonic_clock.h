@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file monotonic_clock.h
+ * @brief File contains helpers for host monotonic timestamps
+ */
+
+#ifndef MONOTONIC_CLOCK_H
+#define MONOTONIC_CLOCK_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Host monotonic clock used to timestamp received data
+ *
+ * All receive timestamps in the application are nanoseconds of this clock
+ * (CLOCK_MONOTONIC on Unix, QueryPerformanceCounter() on Windows), so they
+ * can be compared with each other regardless of wall clock adjustments.
+ */
+namespace MonotonicClock {
+
+/**
+ * @brief Get the current time
+ * @return Monotonic time in nanoseconds
+ */
+qint64 now();
+
+/**
+ * @brief Convert a wall clock (CLOCK_REALTIME) timestamp to monotonic time
+ * @param systemNs wall clock time in nanoseconds since the epoch
+ * @return Corresponding monotonic time in nanoseconds
+ */
+qint64 fromSystemTime(qint64 systemNs);
+
+/**
+ * @brief Get the offset from monotonic time to wall clock time
+ * @return Wall clock time minus monotonic time in nanoseconds
+ */
+qint64 systemOffset();
+
+} // namespace MonotonicClock
+
+#endif // #ifndef MONOTONIC_CLOCK_H
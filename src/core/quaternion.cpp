@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "quaternion.h"
+
+#include <math.h>
+
+Quaternion Quaternion::fromEuler(float roll, float pitch, float yaw)
+{
+    const float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    const float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    const float cy = cosf(yaw * 0.5f), sy = sinf(yaw * 0.5f);
+    Quaternion q;
+    q.w = cr * cp * cy + sr * sp * sy;
+    q.x = sr * cp * cy - cr * sp * sy;
+    q.y = cr * sp * cy + sr * cp * sy;
+    q.z = cr * cp * sy - sr * sp * cy;
+    return q;
+}
+
+Quaternion Quaternion::fromRotationVector(float x, float y, float z)
+{
+    const float angle = sqrtf(x * x + y * y + z * z);
+    Quaternion q;
+    if (angle < 1e-6f) {
+        // sin(a/2)/a tends to 1/2
+        q.x = x * 0.5f;
+        q.y = y * 0.5f;
+        q.z = z * 0.5f;
+        return q;
+    }
+    const float k = sinf(angle * 0.5f) / angle;
+    q.w = cosf(angle * 0.5f);
+    q.x = x * k;
+    q.y = y * k;
+    q.z = z * k;
+    return q;
+}
+
+void Quaternion::toEuler(float *roll, float *pitch, float *yaw) const
+{
+    *roll = atan2f(2 * (w * x + y * z), 1 - 2 * (x * x + y * y));
+    // Clamp to avoid NaN from rounding near the gimbal lock
+    const float sinPitch = 2 * (w * y - z * x);
+    *pitch = asinf(sinPitch > 1 ? 1 : (sinPitch < -1 ? -1 : sinPitch));
+    *yaw = atan2f(2 * (w * z + x * y), 1 - 2 * (y * y + z * z));
+}
+
+Quaternion Quaternion::slerp(const Quaternion &a, const Quaternion &b, float fraction)
+{
+    float dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    // q and -q are the same rotation, take the shorter arc
+    const float sign = dot < 0 ? -1.0f : 1.0f;
+    dot *= sign;
+
+    float ka = 1 - fraction;
+    float kb = fraction;
+    // Nearly parallel quaternions: linear interpolation is exact enough and
+    // avoids dividing by a tiny sine
+    if (dot < 0.9995f) {
+        const float theta = acosf(dot);
+        const float sinTheta = sinf(theta);
+        ka = sinf(ka * theta) / sinTheta;
+        kb = sinf(kb * theta) / sinTheta;
+    }
+    kb *= sign;
+
+    Quaternion q;
+    q.w = ka * a.w + kb * b.w;
+    q.x = ka * a.x + kb * b.x;
+    q.y = ka * a.y + kb * b.y;
+    q.z = ka * a.z + kb * b.z;
+    const float norm = sqrtf(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    q.w /= norm;
+    q.x /= norm;
+    q.y /= norm;
+    q.z /= norm;
+    return q;
+}
+
+Quaternion Quaternion::operator*(const Quaternion &other) const
+{
+    Quaternion q;
+    q.w = w * other.w - x * other.x - y * other.y - z * other.z;
+    q.x = w * other.x + x * other.w + y * other.z - z * other.y;
+    q.y = w * other.y - x * other.z + y * other.w + z * other.x;
+    q.z = w * other.z + x * other.y - y * other.x + z * other.w;
+    return q;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file quaternion.h
+ * @brief File contains a declaration of the attitude quaternion - Quaternion
+ */
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+/**
+ * @brief Unit quaternion describing an attitude
+ *
+ * Rotates from the body frame to the local NED frame, the same convention as
+ * MAVLink ATTITUDE_QUATERNION.
+ */
+struct Quaternion
+{
+    float w = 1;
+    float x = 0;
+    float y = 0;
+    float z = 0;
+
+    /**
+     * @brief Make a quaternion from euler angles (ZYX rotation order)
+     * @param roll roll angle (rad)
+     * @param pitch pitch angle (rad)
+     * @param yaw yaw angle (rad)
+     * @return Unit quaternion
+     */
+    static Quaternion fromEuler(float roll, float pitch, float yaw);
+
+    /**
+     * @brief Make a quaternion rotating by a rotation vector
+     * @param x rotation about the X axis (rad)
+     * @param y rotation about the Y axis (rad)
+     * @param z rotation about the Z axis (rad)
+     * @return Unit quaternion
+     */
+    static Quaternion fromRotationVector(float x, float y, float z);
+
+    /**
+     * @brief Get euler angles (ZYX rotation order)
+     * @param roll roll angle in [-pi, pi] (rad)
+     * @param pitch pitch angle in [-pi/2, pi/2] (rad)
+     * @param yaw yaw angle in [-pi, pi] (rad)
+     */
+    void toEuler(float *roll, float *pitch, float *yaw) const;
+
+    /**
+     * @brief Spherical linear interpolation along the shorter arc
+     * @param a first quaternion
+     * @param b second quaternion
+     * @param fraction position between @p a (0) and @p b (1)
+     * @return Interpolated unit quaternion
+     */
+    static Quaternion slerp(const Quaternion &a, const Quaternion &b, float fraction);
+
+    /**
+     * @brief Compose two rotations
+     * @param other rotation applied in the body frame after this one
+     * @return Product of the quaternions
+     */
+    Quaternion operator*(const Quaternion &other) const;
+};
+
+#endif // #ifndef QUATERNION_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "rate_controller.h"
+
+const double RateController::HighLinkLoad = 0.85;
+const double RateController::LowLinkLoad = 0.7;
+const double RateController::MaxLossRatio = 0.02;
+const double RateController::Decrease = 0.7;
+const double RateController::Increase = 0.1;
+const double RateController::MinRate = 1;
+
+RateController::RateController(double rate, double maxRate) :
+    m_rate(qBound(MinRate, rate, qMax(MinRate, maxRate))), m_maxRate(qMax(MinRate, maxRate))
+{
+}
+
+double RateController::update(const Measurement &measurement)
+{
+    if (measurement.intervalNs <= 0) {
+        return m_rate;
+    }
+    const double seconds = measurement.intervalNs / 1e9;
+
+    double linkLoad = 0;
+    if (measurement.linkCapacity > 0) {
+        linkLoad = measurement.bytes / seconds / measurement.linkCapacity;
+    }
+    const quint64 frames = measurement.frames + measurement.lostFrames;
+    const double lossRatio = frames ? static_cast<double>(measurement.lostFrames) / frames : 0;
+
+    bool queueing = false;
+    if (measurement.deliveryTimeNs > 0) {
+        if (m_minDeliveryTimeNs == 0 || measurement.deliveryTimeNs < m_minDeliveryTimeNs) {
+            m_minDeliveryTimeNs = measurement.deliveryTimeNs;
+        }
+        queueing = measurement.deliveryTimeNs > 2 * m_minDeliveryTimeNs + DeliveryMarginNs;
+    }
+
+    if (linkLoad > HighLinkLoad || lossRatio > MaxLossRatio
+            || measurement.droppedSamples > 0 || queueing) {
+        m_rate = qMax(MinRate, m_rate * Decrease);
+        m_hold = HoldIntervals;
+        return m_rate;
+    }
+
+    if (m_hold > 0) {
+        m_hold--;
+        return m_rate;
+    }
+    // The autopilot may cap the rate, asking for more is pointless then
+    const double inputRate = measurement.samples / seconds;
+    if (linkLoad < LowLinkLoad && inputRate >= 0.8 * m_rate) {
+        m_rate = qMin(m_maxRate, m_rate + qMax(1.0, m_rate * Increase));
+    }
+    return m_rate;
+}
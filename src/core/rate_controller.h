@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file rate_controller.h
+ * @brief File contains a declaration of the adaptive attitude rate control - RateController
+ */
+
+#ifndef RATE_CONTROLLER_H
+#define RATE_CONTROLLER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Choice of the attitude message rate from the link and output load
+ *
+ * The rate is raised step by step while everything keeps up and cut by a
+ * factor as soon as something doesn't (additive increase, multiplicative
+ * decrease). Congestion is:
+ * - the received bytes approaching the serial link capacity, e.g. when the
+ *   telemetry radio is shared;
+ * - frames lost on the link;
+ * - samples dropped because Core or an output couldn't keep up;
+ * - the delivery time of an output (e.g. the HTTP response time) growing
+ *   well above the lowest one seen, which means requests queue up.
+ *
+ * After a decrease the rate is held for a while, so it settles below the
+ * congestion point instead of oscillating around it. The rate isn't raised
+ * while the autopilot doesn't deliver the requested one.
+ */
+class RateController
+{
+public:
+    /**
+     * @brief Link and output state over one control interval
+     */
+    struct Measurement
+    {
+        /**
+         * @brief Length of the interval (ns)
+         */
+        qint64 intervalNs = 0;
+        /**
+         * @brief Attitude samples received
+         */
+        quint64 samples = 0;
+        /**
+         * @brief Bytes received on the link
+         */
+        quint64 bytes = 0;
+        /**
+         * @brief Link capacity (bytes/s), 0 if unknown
+         */
+        qint64 linkCapacity = 0;
+        /**
+         * @brief Frames received and frames lost on the link
+         */
+        quint64 frames = 0;
+        quint64 lostFrames = 0;
+        /**
+         * @brief Samples dropped by Core and the outputs
+         */
+        quint64 droppedSamples = 0;
+        /**
+         * @brief Longest average delivery time of the outputs (ns), 0 if unknown
+         */
+        qint64 deliveryTimeNs = 0;
+    };
+
+    /**
+     * @brief Control interval (ms)
+     */
+    static const int Interval = 1000;
+    /**
+     * @brief Link load above which the rate is decreased
+     */
+    static const double HighLinkLoad;
+    /**
+     * @brief Link load below which the rate may be increased
+     */
+    static const double LowLinkLoad;
+    /**
+     * @brief Share of lost frames above which the rate is decreased
+     */
+    static const double MaxLossRatio;
+    /**
+     * @brief Delivery time tolerated over twice the lowest one (ns)
+     */
+    static const qint64 DeliveryMarginNs = 5000000;
+    /**
+     * @brief Factor the rate is multiplied by on congestion
+     */
+    static const double Decrease;
+    /**
+     * @brief Share of the rate it is increased by, at least 1 Hz
+     */
+    static const double Increase;
+    /**
+     * @brief Intervals the rate is held for after a decrease
+     */
+    static const int HoldIntervals = 5;
+    /**
+     * @brief Lowest rate (Hz)
+     */
+    static const double MinRate;
+
+    /**
+     * @brief Create a controller
+     * @param rate initial rate (Hz)
+     * @param maxRate highest rate (Hz)
+     */
+    RateController(double rate, double maxRate);
+
+    /**
+     * @brief Get the current rate
+     * @return Rate (Hz)
+     */
+    double rate() const { return m_rate; }
+
+    /**
+     * @brief Update the rate with a new measurement
+     * @param measurement state over the last interval
+     * @return New rate (Hz)
+     */
+    double update(const Measurement &measurement);
+
+private:
+    /**
+     * @brief Current rate (Hz)
+     */
+    double m_rate;
+    /**
+     * @brief Highest rate (Hz)
+     */
+    double m_maxRate;
+    /**
+     * @brief Intervals left before the rate may be increased
+     */
+    int m_hold = 0;
+    /**
+     * @brief Lowest delivery time seen (ns), 0 if none
+     */
+    qint64 m_minDeliveryTimeNs = 0;
+};
+
+#endif // #ifndef RATE_CONTROLLER_H
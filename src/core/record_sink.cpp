@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "record_sink.h"
+#include "monotonic_clock.h"
+#include "quaternion.h"
+
+#include <string.h>
+
+static_assert(sizeof(AttitudeRecord) == 64, "AttitudeRecord layout changed");
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "AttitudeRecord is sent in host byte order, which must be little-endian"
+#endif
+
+RecordSink::RecordSink(QObject *parent) :
+    AttitudeSink(parent)
+{
+    memset(&m_record, 0, sizeof(m_record));
+    m_record.magic = ATTITUDE_RECORD_MAGIC;
+    m_record.version = ATTITUDE_RECORD_VERSION;
+}
+
+void RecordSink::write(const AttitudeSample &sample)
+{
+    m_record.seq++;
+    m_record.timeUs = (sample.rxTimeNs + MonotonicClock::systemOffset()) / 1000;
+    m_record.timeBootMs = sample.timeBootMs;
+    m_record.roll = sample.roll;
+    m_record.pitch = sample.pitch;
+    m_record.yaw = sample.yaw;
+    m_record.rollspeed = sample.rollspeed;
+    m_record.pitchspeed = sample.pitchspeed;
+    m_record.yawspeed = sample.yawspeed;
+
+    const Quaternion q = Quaternion::fromEuler(sample.roll, sample.pitch, sample.yaw);
+    m_record.q[0] = q.w;
+    m_record.q[1] = q.x;
+    m_record.q[2] = q.y;
+    m_record.q[3] = q.z;
+    m_record.predictionUs = static_cast<qint32>(sample.predictionNs / 1000);
+    m_record.flags = ATTITUDE_RECORD_FLAG_QUATERNION;
+    if (sample.predictionNs != 0) {
+        m_record.flags |= ATTITUDE_RECORD_FLAG_PREDICTED;
+    }
+
+    if (!sendRecord(m_record)) {
+        m_droppedRecords++;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file record_sink.h
+ * @brief File contains a declaration of the binary record output base - RecordSink
+ */
+
+#ifndef RECORD_SINK_H
+#define RECORD_SINK_H
+
+#include "attitude_record.h"
+#include "attitude_sink.h"
+
+/**
+ * @brief Base of outputs sending every sample as one binary AttitudeRecord
+ *
+ * Fills a reused record and passes it to sendRecord(). Records which could
+ * not be sent are counted, there is no retry.
+ */
+class RecordSink : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    RecordSink(QObject *parent = Q_NULLPTR);
+
+    /**
+     * @brief Send an attitude sample as a binary record
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+
+    /**
+     * @brief Get the number of records which were not sent
+     * @return Dropped records count
+     */
+    quint64 droppedRecords() const { return m_droppedRecords; }
+
+protected:
+    /**
+     * @brief Send a record
+     * @param record record to send
+     * @return true on success, false if the record was not sent
+     */
+    virtual bool sendRecord(const AttitudeRecord &record) = 0;
+
+private:
+    /**
+     * @brief Record reused for every sample
+     */
+    AttitudeRecord m_record;
+    /**
+     * @brief Records which were not sent
+     */
+    quint64 m_droppedRecords = 0;
+};
+
+#endif // #ifndef RECORD_SINK_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file rx_buffer.h
+ * @brief File contains a declaration of the link receive buffer - RxBuffer
+ */
+
+#ifndef RX_BUFFER_H
+#define RX_BUFFER_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+/**
+ * @brief Fixed-capacity receive buffer of a MAVLink link
+ *
+ * Devices read straight into the free space at the end of the buffer and
+ * the parser decodes frames in place from the unread region. The storage is
+ * allocated once; when the write position gets close to the end, the unread
+ * tail (at most one partial frame) is moved back to the front, so frames are
+ * always contiguous in memory.
+ */
+class RxBuffer
+{
+public:
+    /**
+     * @brief Construct a buffer
+     * @param capacity buffer size in bytes
+     */
+    explicit RxBuffer(size_t capacity);
+
+    /**
+     * @brief Drop all buffered data
+     */
+    void clear() { m_readPos = m_writePos = 0; }
+
+    /**
+     * @brief Prepare contiguous free space for the next read
+     *
+     * Moves the unread data to the front of the buffer if less than
+     * @p minimum bytes are free at the end.
+     *
+     * @param minimum free space wanted
+     */
+    void reserve(size_t minimum);
+
+    /**
+     * @brief Get the position to read new data into
+     * @return Pointer to writeSpace() free bytes
+     */
+    quint8 *writePointer() { return m_data.data() + m_writePos; }
+    /**
+     * @brief Get the contiguous free space
+     * @return Number of bytes which may be written at writePointer()
+     */
+    size_t writeSpace() const { return m_data.size() - m_writePos; }
+    /**
+     * @brief Mark freshly written bytes as readable
+     * @param size number of bytes written at writePointer()
+     */
+    void commit(size_t size) { m_writePos += size; }
+
+    /**
+     * @brief Get the unread data
+     * @return Pointer to readSize() unread bytes
+     */
+    const quint8 *readPointer() const { return m_data.data() + m_readPos; }
+    /**
+     * @brief Get the amount of unread data
+     * @return Number of unread bytes
+     */
+    size_t readSize() const { return m_writePos - m_readPos; }
+    /**
+     * @brief Release processed bytes
+     * @param size number of bytes processed at readPointer()
+     */
+    void consume(size_t size);
+
+private:
+    /**
+     * @brief Buffer storage, allocated once
+     */
+    std::vector<quint8> m_data;
+    /**
+     * @brief Position of the first unread byte
+     */
+    size_t m_readPos = 0;
+    /**
+     * @brief Position of the first free byte
+     */
+    size_t m_writePos = 0;
+};
+
+#endif // #ifndef RX_BUFFER_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "shm_sink.h"
+
+#include <QDebug>
+
+#include <errno.h>
+
+ShmSink::ShmSink(QObject *parent) :
+    RecordSink(parent)
+{
+}
+
+ShmSink::~ShmSink()
+{
+    close();
+}
+
+bool ShmSink::open()
+{
+    close();
+    const QByteArray name = m_name.toLocal8Bit();
+    const int fd = shm_open(name.constData(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(AttitudeShm)) != 0) {
+        qWarning().noquote() << tr("Warning: Failed to create shared memory '%1' (%2).")
+                                .arg(m_name)
+                                .arg(QString::fromLocal8Bit(strerror(errno)));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    void *memory = mmap(Q_NULLPTR, sizeof(AttitudeShm), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        qWarning().noquote() << tr("Warning: Failed to map shared memory '%1' (%2).")
+                                .arg(m_name)
+                                .arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    m_shm = static_cast<AttitudeShm *>(memory);
+
+    // Keep the seqlock counters of a segment left by a previous run, readers
+    // may still hold copies of them
+    if (m_shm->magic != ATTITUDE_SHM_MAGIC || m_shm->version != ATTITUDE_SHM_VERSION
+            || m_shm->ringSize != ATTITUDE_SHM_RING_SIZE) {
+        memset(m_shm, 0, sizeof(AttitudeShm));
+        m_shm->ringSize = ATTITUDE_SHM_RING_SIZE;
+        m_shm->version = ATTITUDE_SHM_VERSION;
+        __atomic_store_n(&m_shm->magic, ATTITUDE_SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+void ShmSink::close()
+{
+    if (m_shm) {
+        munmap(m_shm, sizeof(AttitudeShm));
+        m_shm = Q_NULLPTR;
+    }
+}
+
+bool ShmSink::sendRecord(const AttitudeRecord &record)
+{
+    if (!m_shm) {
+        return false;
+    }
+    const quint64 count = m_shm->count;
+    writeSlot(&m_shm->ring[count % ATTITUDE_SHM_RING_SIZE], record);
+    __atomic_store_n(&m_shm->count, count + 1, __ATOMIC_RELEASE);
+    writeSlot(&m_shm->latest, record);
+    return true;
+}
+
+void ShmSink::writeSlot(AttitudeShmSlot *slot, const AttitudeRecord &record)
+{
+    // A reused segment keeps an odd seq if its writer crashed mid-write,
+    // so mark the write with the next odd value instead of seq + 1
+    const quint32 seq = slot->seq | 1;
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->record, &record, sizeof(record));
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file shm_sink.h
+ * @brief File contains a declaration of the shared memory attitude output - ShmSink
+ */
+
+#ifndef SHM_SINK_H
+#define SHM_SINK_H
+
+#include <QString>
+
+#include "attitude_shm.h"
+#include "record_sink.h"
+
+/**
+ * @brief Attitude output publishing records in POSIX shared memory
+ *
+ * Creates (or reuses) a shared memory segment laid out as AttitudeShm and
+ * writes every record to the latest slot and to the ring, each guarded by a
+ * seqlock. Readers on the same host use attitude_shm.h and need no system
+ * calls after attaching. The segment is left in place on close, so readers
+ * survive a feeder restart.
+ */
+class ShmSink : public RecordSink
+{
+    Q_OBJECT
+public:
+    ShmSink(QObject *parent = Q_NULLPTR);
+    virtual ~ShmSink();
+
+    /**
+     * @brief Set the segment name
+     * @param name POSIX shared memory name, e.g. "/attfeeder"
+     */
+    void setName(const QString &name) { m_name = name; }
+    /**
+     * @brief Get the segment name
+     * @return POSIX shared memory name
+     */
+    QString name() const { return m_name; }
+
+    /**
+     * @brief Create and map the segment
+     * @return true on success, false otherwise
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Unmap the segment
+     */
+    void close() Q_DECL_OVERRIDE;
+
+protected:
+    bool sendRecord(const AttitudeRecord &record) Q_DECL_OVERRIDE;
+
+private:
+    /**
+     * @brief Write a record to a slot under its seqlock
+     * @param slot slot to write
+     * @param record record to write
+     */
+    static void writeSlot(AttitudeShmSlot *slot, const AttitudeRecord &record);
+
+private:
+    /**
+     * @brief Segment name
+     */
+    QString m_name = "/attfeeder";
+    /**
+     * @brief Mapped segment, Q_NULLPTR if closed
+     */
+    AttitudeShm *m_shm = Q_NULLPTR;
+};
+
+#endif // #ifndef SHM_SINK_H
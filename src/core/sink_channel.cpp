@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "sink_channel.h"
+#include "attitude_predictor.h"
+#include "monotonic_clock.h"
+
+#include <QDebug>
+
+#include <math.h>
+
+SinkChannel::SinkChannel(AttitudeSink *sink, const SinkPolicy &policy,
+                         QObject *parent) :
+    QObject(parent), m_sink(sink), m_policy(policy)
+{
+    m_sink->setParent(this);
+    m_policy.decimation = qMax(1, m_policy.decimation);
+    m_policy.queueDepth = qMax(1, m_policy.queueDepth);
+    if (m_policy.rate > 0) {
+        m_periodNs = static_cast<qint64>(1e9 / m_policy.rate);
+    }
+    m_queue.resize(m_policy.queueDepth);
+
+    connect(m_sink, &AttitudeSink::ready, this, &SinkChannel::drain);
+}
+
+void SinkChannel::push(const AttitudeSample &sample)
+{
+    if (m_periodCount == 0) {
+        m_periodStartNs = sample.rxTimeNs;
+        if (m_policy.average) {
+            m_sinRoll = m_cosRoll = 0;
+            m_sinPitch = m_cosPitch = 0;
+            m_sinYaw = m_cosYaw = 0;
+            m_rollspeed = m_pitchspeed = m_yawspeed = 0;
+            m_rxTimeNs = m_timeBootMs = m_latencyNs = 0;
+        }
+    }
+    m_periodCount++;
+    m_latest = sample;
+    if (m_policy.average) {
+        m_sinRoll += sin(sample.roll);
+        m_cosRoll += cos(sample.roll);
+        m_sinPitch += sin(sample.pitch);
+        m_cosPitch += cos(sample.pitch);
+        m_sinYaw += sin(sample.yaw);
+        m_cosYaw += cos(sample.yaw);
+        m_rollspeed += sample.rollspeed;
+        m_pitchspeed += sample.pitchspeed;
+        m_yawspeed += sample.yawspeed;
+        // Relative to the period start to keep the precision
+        m_rxTimeNs += sample.rxTimeNs - m_periodStartNs;
+        m_timeBootMs += sample.timeBootMs;
+        m_latencyNs += sample.latencyNs;
+    }
+
+    if (m_periodCount < m_policy.decimation) {
+        return;
+    }
+    if (m_periodNs > 0 && m_lastOutputNs != 0
+            && sample.rxTimeNs - m_lastOutputNs < m_periodNs) {
+        return;
+    }
+    m_lastOutputNs = sample.rxTimeNs;
+    emitSample(m_policy.average ? averageSample() : m_latest);
+    m_periodCount = 0;
+}
+
+void SinkChannel::reset()
+{
+    if (m_droppedSamples) {
+        qInfo().noquote() << tr("Output '%1': %2 queued samples dropped.")
+                             .arg(m_sink->objectName())
+                             .arg(m_droppedSamples);
+        m_droppedSamples = 0;
+    }
+    if (m_writtenSamples) {
+        qInfo().noquote() << tr("Output '%1': average attitude age %2 ms%3.")
+                             .arg(m_sink->objectName())
+                             .arg(averageAgeNs() / 1e6, 0, 'f', 1)
+                             .arg(m_policy.predict ? tr(", compensated") : QString());
+        m_writtenSamples = 0;
+        m_ageSumNs = 0;
+    }
+    m_periodCount = 0;
+    m_lastOutputNs = 0;
+    m_queueHead = 0;
+    m_queueSize = 0;
+}
+
+qint64 SinkChannel::averageAgeNs() const
+{
+    if (m_writtenSamples == 0) {
+        return 0;
+    }
+    return m_ageSumNs / static_cast<qint64>(m_writtenSamples);
+}
+
+void SinkChannel::emitSample(const AttitudeSample &sample)
+{
+    if (m_queueSize == 0 && !m_sink->isBusy()) {
+        writeSample(sample);
+        return;
+    }
+    if (m_queueSize == m_queue.size()) {
+        // Full, the oldest sample is the least useful one
+        m_queueHead = (m_queueHead + 1) % m_queue.size();
+        m_queueSize--;
+        m_droppedSamples++;
+    }
+    m_queue[(m_queueHead + m_queueSize) % m_queue.size()] = sample;
+    m_queueSize++;
+}
+
+void SinkChannel::drain()
+{
+    while (m_queueSize > 0 && !m_sink->isBusy()) {
+        writeSample(m_queue[m_queueHead]);
+        m_queueHead = (m_queueHead + 1) % m_queue.size();
+        m_queueSize--;
+    }
+}
+
+void SinkChannel::writeSample(const AttitudeSample &sample)
+{
+    const qint64 ageNs = sample.latencyNs + MonotonicClock::now() - sample.rxTimeNs;
+    m_writtenSamples++;
+    m_ageSumNs += ageNs;
+    if (!m_policy.predict) {
+        m_sink->write(sample);
+        return;
+    }
+    const qint64 leadNs = static_cast<qint64>(m_policy.predictLeadMs * 1e6);
+    m_sink->write(AttitudePredictor::predict(sample, ageNs + leadNs));
+}
+
+AttitudeSample SinkChannel::averageSample() const
+{
+    const double count = m_periodCount;
+    AttitudeSample sample;
+    sample.rxTimeNs = m_periodStartNs + static_cast<qint64>(m_rxTimeNs / count);
+    sample.timeBootMs = static_cast<quint32>(m_timeBootMs / count + 0.5);
+    sample.latencyNs = static_cast<qint64>(m_latencyNs / count);
+    if (m_latest.timeNs != 0) {
+        sample.timeNs = sample.rxTimeNs - sample.latencyNs;
+    }
+    sample.roll = static_cast<float>(atan2(m_sinRoll, m_cosRoll));
+    sample.pitch = static_cast<float>(atan2(m_sinPitch, m_cosPitch));
+    sample.yaw = static_cast<float>(atan2(m_sinYaw, m_cosYaw));
+    sample.rollspeed = static_cast<float>(m_rollspeed / count);
+    sample.pitchspeed = static_cast<float>(m_pitchspeed / count);
+    sample.yawspeed = static_cast<float>(m_yawspeed / count);
+    return sample;
+}
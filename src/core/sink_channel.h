@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file sink_channel.h
+ * @brief File contains a declaration of the per-output fan-out stage - SinkChannel
+ */
+
+#ifndef SINK_CHANNEL_H
+#define SINK_CHANNEL_H
+
+#include <QObject>
+#include <QVector>
+
+#include "attitude_sample.h"
+#include "attitude_sink.h"
+
+/**
+ * @brief Output policy of one attitude sink
+ */
+struct SinkPolicy
+{
+    /**
+     * @brief Maximal output rate (Hz), 0 for no limit
+     */
+    double rate = 0;
+    /**
+     * @brief Output every n-th sample, 1 for every sample
+     */
+    int decimation = 1;
+    /**
+     * @brief Output the average of the skipped samples instead of the latest
+     */
+    bool average = false;
+    /**
+     * @brief Samples kept while the sink is busy, the oldest are dropped
+     */
+    int queueDepth = 1;
+    /**
+     * @brief Project samples forward to compensate their latency
+     */
+    bool predict = false;
+    /**
+     * @brief Time to project samples beyond their delivery to the sink (ms)
+     */
+    double predictLeadMs = 0;
+};
+
+/**
+ * @brief Fan-out stage feeding one attitude sink according to its policy
+ *
+ * Core pushes every sample to every channel. A channel reduces the stream
+ * to its sink's rate (by time and/or by count, keeping the latest sample or
+ * averaging them) and queues the result while the sink is busy. Sinks never
+ * block and a busy sink only fills its own queue, so a slow output doesn't
+ * hold back the others.
+ *
+ * With prediction enabled, a sample is projected forward by its age at the
+ * moment the sink takes it: the estimated link delay plus the time since it
+ * was received, plus a configured lead. The average age is reported when
+ * the channel is reset.
+ */
+class SinkChannel : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Create a channel
+     * @param sink attitude sink, owned by the channel
+     * @param policy output policy
+     * @param parent parent object
+     */
+    SinkChannel(AttitudeSink *sink, const SinkPolicy &policy,
+                QObject *parent = Q_NULLPTR);
+
+    /**
+     * @brief Get the fed sink
+     * @return Attitude sink
+     */
+    AttitudeSink *sink() const { return m_sink; }
+    /**
+     * @brief Get the output policy
+     * @return Output policy
+     */
+    const SinkPolicy &policy() const { return m_policy; }
+
+    /**
+     * @brief Handle a new sample
+     * @param sample attitude sample
+     */
+    void push(const AttitudeSample &sample);
+    /**
+     * @brief Drop queued and partially averaged samples
+     */
+    void reset();
+
+    /**
+     * @brief Get the number of samples dropped because the queue was full
+     * @return Dropped samples count
+     */
+    quint64 droppedSamples() const { return m_droppedSamples; }
+    /**
+     * @brief Get the average age of samples taken by the sink
+     * @return Age since the autopilot measurement (ns), link delay estimated
+     */
+    qint64 averageAgeNs() const;
+
+private slots:
+    /**
+     * @brief Pass queued samples to the sink while it is not busy
+     */
+    void drain();
+
+private:
+    /**
+     * @brief Pass a reduced sample on to the sink or the queue
+     * @param sample reduced sample
+     */
+    void emitSample(const AttitudeSample &sample);
+    /**
+     * @brief Pass a sample to the sink, projecting it forward if enabled
+     * @param sample sample to write
+     */
+    void writeSample(const AttitudeSample &sample);
+    /**
+     * @brief Compute the average of the accumulated samples
+     * @return Average sample
+     */
+    AttitudeSample averageSample() const;
+
+private:
+    /**
+     * @brief Fed sink
+     */
+    AttitudeSink *m_sink;
+    /**
+     * @brief Output policy
+     */
+    SinkPolicy m_policy;
+    /**
+     * @brief Minimal time between output samples (ns), 0 for no limit
+     */
+    qint64 m_periodNs = 0;
+
+    /**
+     * @brief Receive time of the last output sample (ns), 0 if none
+     */
+    qint64 m_lastOutputNs = 0;
+    /**
+     * @brief Receive time of the first sample of the current period (ns)
+     */
+    qint64 m_periodStartNs = 0;
+    /**
+     * @brief Samples in the current period
+     */
+    int m_periodCount = 0;
+    /**
+     * @brief Latest sample of the current period
+     */
+    AttitudeSample m_latest;
+    /**
+     * @brief Sums of the current period used by averaging
+     *
+     * Angles are summed as sines and cosines, so averaging works across
+     * the +-pi wrap.
+     */
+    double m_sinRoll = 0, m_cosRoll = 0;
+    double m_sinPitch = 0, m_cosPitch = 0;
+    double m_sinYaw = 0, m_cosYaw = 0;
+    double m_rollspeed = 0, m_pitchspeed = 0, m_yawspeed = 0;
+    double m_rxTimeNs = 0, m_timeBootMs = 0, m_latencyNs = 0;
+
+    /**
+     * @brief Samples waiting for the sink, a ring of queueDepth entries
+     */
+    QVector<AttitudeSample> m_queue;
+    /**
+     * @brief Index of the oldest queued sample
+     */
+    int m_queueHead = 0;
+    /**
+     * @brief Number of queued samples
+     */
+    int m_queueSize = 0;
+    /**
+     * @brief Samples dropped because the queue was full
+     */
+    quint64 m_droppedSamples = 0;
+    /**
+     * @brief Samples taken by the sink and the sum of their ages (ns)
+     */
+    quint64 m_writtenSamples = 0;
+    qint64 m_ageSumNs = 0;
+};
+
+#endif // #ifndef SINK_CHANNEL_H
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "sink_config.h"
+#include "attitude_server.h"
+#include "file_sink.h"
+#include "http2_sink.h"
+#include "http_sink.h"
+#include "udp_sink.h"
+#include "websocket_sink.h"
+#ifdef Q_OS_UNIX
+#include "shm_sink.h"
+#include "unix_sink.h"
+#endif
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QSettings>
+#include <QStringList>
+#include <QUrl>
+
+namespace {
+QString tr(const char *key)
+{
+    return QCoreApplication::translate("SinkConfig", key);
+}
+
+/**
+ * @brief Take an integer option
+ * @param options options, the taken one is removed
+ * @param name option name
+ * @param value parsed value, unchanged if the option is not set
+ * @param error error description on failure
+ * @return true on success, false if the value is not a positive integer
+ */
+bool takeInt(QMap<QString, QString> &options, const QString &name,
+             int *value, QString *error)
+{
+    if (!options.contains(name)) {
+        return true;
+    }
+    bool ok = false;
+    const int parsed = options.take(name).toInt(&ok);
+    if (!ok || parsed < 0) {
+        *error = tr("Invalid value of option '%1'.").arg(name);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+}
+
+bool SinkConfig::create(const QString &type, const QString &target,
+                        const QMap<QString, QString> &options,
+                        Entry *entry, QString *error)
+{
+    QMap<QString, QString> rest = options;
+    SinkPolicy policy;
+    if (rest.contains("rate")) {
+        bool ok = false;
+        policy.rate = rest.take("rate").toDouble(&ok);
+        if (!ok || policy.rate < 0) {
+            *error = tr("Invalid value of option 'rate'.");
+            return false;
+        }
+    }
+    if (!takeInt(rest, "decimate", &policy.decimation, error)
+            || !takeInt(rest, "queue", &policy.queueDepth, error)) {
+        return false;
+    }
+    if (rest.contains("average")) {
+        rest.remove("average");
+        policy.average = true;
+    }
+    if (rest.contains("predict")) {
+        const QString lead = rest.take("predict");
+        policy.predict = true;
+        if (!lead.isEmpty() && lead != "true") {
+            bool ok = false;
+            policy.predictLeadMs = lead.toDouble(&ok);
+            if (!ok) {
+                *error = tr("Invalid value of option 'predict'.");
+                return false;
+            }
+        }
+    }
+
+    AttitudeSink *sink = Q_NULLPTR;
+    if (type == "http") {
+        int inflight = HttpSink::DefaultMaxInFlight;
+        int batch = 0;
+        int batchInterval = 0;
+        if (!takeInt(rest, "inflight", &inflight, error)
+                || !takeInt(rest, "batch", &batch, error)
+                || !takeInt(rest, "batchms", &batchInterval, error)) {
+            return false;
+        }
+        HttpSink *httpSink = new HttpSink();
+        if (!target.isEmpty()) {
+            httpSink->setUrl(QUrl(target));
+        }
+        httpSink->setMaxInFlight(inflight);
+        httpSink->setBatch(batch, batchInterval);
+        sink = httpSink;
+    } else if (type == "h2c") {
+        int inflight = 0;
+        if (!takeInt(rest, "inflight", &inflight, error)) {
+            return false;
+        }
+        Http2Sink *http2Sink = new Http2Sink();
+        if (!target.isEmpty()) {
+            http2Sink->setUrl(QUrl(target));
+        }
+        http2Sink->setMaxInFlight(inflight);
+        sink = http2Sink;
+    } else if (type == "ws") {
+        WebSocketSink *webSocketSink = new WebSocketSink();
+        webSocketSink->setUrl(QUrl(target));
+        sink = webSocketSink;
+    } else if (type == "udp") {
+        int ttl = 1;
+        if (!takeInt(rest, "ttl", &ttl, error)) {
+            return false;
+        }
+        const int separator = target.lastIndexOf(':');
+        const QHostAddress address(target.left(separator));
+        const quint16 port = target.mid(separator + 1).toUShort();
+        if (separator < 0 || address.isNull() || port == 0) {
+            *error = tr("Invalid UDP output address '%1'.").arg(target);
+            return false;
+        }
+        UdpSink *udpSink = new UdpSink();
+        udpSink->setDestination(address, port);
+        udpSink->setMulticastTtl(ttl);
+        sink = udpSink;
+#ifdef Q_OS_UNIX
+    } else if (type == "unix") {
+        UnixSink *unixSink = new UnixSink();
+        unixSink->setPath(target);
+        sink = unixSink;
+    } else if (type == "shm") {
+        ShmSink *shmSink = new ShmSink();
+        if (!target.isEmpty()) {
+            shmSink->setName(target);
+        }
+        sink = shmSink;
+#endif
+    } else if (type == "server") {
+        const int separator = target.lastIndexOf(':');
+        const QHostAddress address = separator < 0
+                ? QHostAddress(QHostAddress::LocalHost)
+                : QHostAddress(target.left(separator));
+        const quint16 port = target.mid(separator + 1).toUShort();
+        if (address.isNull() || port == 0) {
+            *error = tr("Invalid HTTP server address '%1'.").arg(target);
+            return false;
+        }
+        AttitudeServer *server = new AttitudeServer();
+        server->setListenAddress(address, port);
+        sink = server;
+    } else if (type == "file") {
+        FileSink *fileSink = new FileSink();
+        fileSink->setFileName(target);
+        sink = fileSink;
+    } else {
+        *error = tr("Unknown output type '%1'.").arg(type);
+        return false;
+    }
+
+    if (!rest.isEmpty()) {
+        delete sink;
+        *error = tr("Unknown option '%1' of '%2' output.")
+                .arg(rest.firstKey())
+                .arg(type);
+        return false;
+    }
+    sink->setObjectName(type);
+    entry->sink = sink;
+    entry->policy = policy;
+    return true;
+}
+
+bool SinkConfig::parse(const QString &spec, Entry *entry, QString *error)
+{
+    const int typeEnd = spec.indexOf(':');
+    if (typeEnd <= 0) {
+        *error = tr("Invalid output '%1', expected '<type>:<target>'.").arg(spec);
+        return false;
+    }
+    QStringList parts = spec.mid(typeEnd + 1).split(',');
+    const QString target = parts.takeFirst();
+
+    QMap<QString, QString> options;
+    for (const QString &part : parts) {
+        const int separator = part.indexOf('=');
+        if (separator < 0) {
+            options.insert(part, QString());
+        } else {
+            options.insert(part.left(separator), part.mid(separator + 1));
+        }
+    }
+    return create(spec.left(typeEnd), target, options, entry, error);
+}
+
+bool SinkConfig::load(const QString &fileName, QList<Entry> *entries, QString *error)
+{
+    if (!QFileInfo(fileName).exists()) {
+        *error = tr("Config file '%1' not found.").arg(fileName);
+        return false;
+    }
+    QSettings settings(fileName, QSettings::IniFormat);
+    if (settings.status() != QSettings::NoError) {
+        *error = tr("Failed to read config file '%1'.").arg(fileName);
+        return false;
+    }
+
+    for (const QString &group : settings.childGroups()) {
+        settings.beginGroup(group);
+        QMap<QString, QString> options;
+        for (const QString &key : settings.childKeys()) {
+            options.insert(key, settings.value(key).toString());
+        }
+        settings.endGroup();
+
+        const QString type = options.take("type");
+        const QString target = options.take("target");
+        // INI flags are written as "average=true"
+        if (options.contains("average")) {
+            const QString value = options.value("average");
+            if (value == "false" || value == "0") {
+                options.remove("average");
+            }
+        }
+        if (options.value("predict") == "false") {
+            options.remove("predict");
+        }
+        Entry entry;
+        if (!create(type, target, options, &entry, error)) {
+            *error = QString("[%1] %2").arg(group).arg(*error);
+            return false;
+        }
+        entry.sink->setObjectName(group);
+        entries->append(entry);
+    }
+    return true;
+}
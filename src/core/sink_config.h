@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file sink_config.h
+ * @brief File contains helpers creating attitude sinks from their configuration
+ */
+
+#ifndef SINK_CONFIG_H
+#define SINK_CONFIG_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include "attitude_sink.h"
+#include "sink_channel.h"
+
+/**
+ * @brief Creation of attitude sinks from command line specs and config files
+ *
+ * A sink is described by a type, a target and options:
+ * - http: Camera Adapter API URL, options "inflight=<count>" (default 1),
+ *   "batch=<samples>" and "batchms=<ms>";
+ * - h2c: Camera Adapter API URL over HTTP/2, option "inflight=<count>";
+ * - ws: WebSocket URL;
+ * - udp: "<address>:<port>", option "ttl=<ttl>" for multicast groups;
+ * - unix: Unix datagram socket path (Unix only);
+ * - shm: POSIX shared memory name (Unix only);
+ * - server: embedded HTTP server "[<address>:]<port>", localhost by default;
+ * - file: CSV file path.
+ *
+ * Options common to all types set the SinkPolicy: "rate=<Hz>",
+ * "decimate=<n>", "average", "queue=<depth>" and "predict[=<lead ms>]".
+ */
+namespace SinkConfig {
+
+/**
+ * @brief Configured sink
+ */
+struct Entry
+{
+    AttitudeSink *sink = Q_NULLPTR;
+    SinkPolicy policy;
+};
+
+/**
+ * @brief Create a sink
+ * @param type sink type
+ * @param target type specific target
+ * @param options option values by name, flags have empty values
+ * @param entry created sink and its policy
+ * @param error error description on failure
+ * @return true on success, false otherwise
+ */
+bool create(const QString &type, const QString &target,
+            const QMap<QString, QString> &options,
+            Entry *entry, QString *error);
+
+/**
+ * @brief Create a sink from a command line spec
+ * @param spec "<type>:<target>[,<option>[=<value>]...]",
+ *             e.g. "udp:239.0.0.1:14600,rate=50,average"
+ * @param entry created sink and its policy
+ * @param error error description on failure
+ * @return true on success, false otherwise
+ */
+bool parse(const QString &spec, Entry *entry, QString *error);
+
+/**
+ * @brief Create sinks from an INI file
+ *
+ * Every group describes one sink with the "type" and "target" keys and
+ * optional option keys, e.g.
+ * @code
+ * [gimbal]
+ * type=udp
+ * target=192.168.1.20:14600
+ * rate=100
+ * @endcode
+ *
+ * @param fileName config file path
+ * @param entries created sinks, appended
+ * @param error error description on failure
+ * @return true on success, false otherwise
+ */
+bool load(const QString &fileName, QList<Entry> *entries, QString *error);
+
+} // namespace SinkConfig
+
+#endif // #ifndef SINK_CONFIG_H
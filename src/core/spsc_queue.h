@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file spsc_queue.h
+ * @brief File contains a bounded lock-free single-producer/single-consumer queue
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * One thread may push() while another thread pop()s without any locking.
+ * Producer and consumer indices are padded to separate cache lines so the
+ * two threads don't invalidate each other's caches on every operation.
+ *
+ * @tparam T element type, copied in and out of the queue
+ * @tparam Capacity maximal number of queued elements, a power of two
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+
+    /**
+     * @brief Append an element (producer side)
+     * @param value element to append
+     * @return false if the queue is full and the element was not added
+     */
+    bool push(const T &value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        m_items[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest element (consumer side)
+     * @param value receives the element
+     * @return false if the queue is empty
+     */
+    bool pop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Check whether the queue is empty
+     * @return true if there is nothing to pop
+     */
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) ==
+                m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    /**
+     * @brief Assumed cache line size
+     */
+    static const size_t CacheLine = 64;
+
+    /**
+     * @brief Index of the next element to pop, written by the consumer
+     */
+    std::atomic<size_t> m_head;
+    char m_headPadding[CacheLine - sizeof(std::atomic<size_t>)];
+    /**
+     * @brief Index of the next free slot, written by the producer
+     */
+    std::atomic<size_t> m_tail;
+    char m_tailPadding[CacheLine - sizeof(std::atomic<size_t>)];
+    /**
+     * @brief Queue storage
+     */
+    T m_items[Capacity];
+};
+
+#endif // #ifndef SPSC_QUEUE_H
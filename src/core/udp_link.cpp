@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "udp_link.h"
+#include "monotonic_clock.h"
+
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+UdpLink::UdpLink(QObject *parent) :
+    QIODevice(parent), m_storage(BatchSize * MaxDatagramSize)
+#ifndef Q_OS_LINUX
+  , m_socket(this)
+#endif
+{
+#ifdef Q_OS_LINUX
+    memset(m_headers, 0, sizeof(m_headers));
+    for (int i = 0; i < BatchSize; ++i) {
+        m_iovecs[i].iov_base = m_storage.data() + i * MaxDatagramSize;
+        m_iovecs[i].iov_len = MaxDatagramSize;
+        m_headers[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_headers[i].msg_hdr.msg_iovlen = 1;
+        m_headers[i].msg_hdr.msg_name = &m_senders[i];
+        m_headers[i].msg_hdr.msg_control = m_control[i];
+    }
+#else
+    connect(&m_socket, &QUdpSocket::readyRead, this, &UdpLink::readyRead);
+#endif
+}
+
+UdpLink::~UdpLink()
+{
+    close();
+}
+
+bool UdpLink::open(OpenMode mode)
+{
+    if (isOpen()) {
+        close();
+    }
+    m_peerAddress = QHostAddress();
+    m_peerPort = 0;
+
+#ifdef Q_OS_LINUX
+    m_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        setErrorString(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    int enable = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    ::setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(m_port);
+    if (::bind(m_fd, reinterpret_cast<struct sockaddr *>(&address),
+               sizeof(address)) != 0) {
+        setErrorString(QString::fromLocal8Bit(strerror(errno)));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated,
+            this, &UdpLink::readyRead);
+#else
+    if (!m_socket.bind(QHostAddress::AnyIPv4, m_port,
+                       QAbstractSocket::ShareAddress |
+                       QAbstractSocket::ReuseAddressHint)) {
+        setErrorString(m_socket.errorString());
+        return false;
+    }
+#endif
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void UdpLink::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    QIODevice::close();
+#ifdef Q_OS_LINUX
+    delete m_notifier;
+    m_notifier = Q_NULLPTR;
+    ::close(m_fd);
+    m_fd = -1;
+#else
+    m_socket.close();
+#endif
+}
+
+int UdpLink::receive()
+{
+    int count = 0;
+#ifdef Q_OS_LINUX
+    if (m_fd < 0) {
+        return 0;
+    }
+    for (int i = 0; i < BatchSize; ++i) {
+        m_headers[i].msg_hdr.msg_namelen = sizeof(m_senders[i]);
+        m_headers[i].msg_hdr.msg_controllen = sizeof(m_control[i]);
+    }
+    const int received = ::recvmmsg(m_fd, m_headers, BatchSize, MSG_DONTWAIT,
+                                    Q_NULLPTR);
+    const qint64 now = MonotonicClock::now();
+    const qint64 systemOffset = MonotonicClock::systemOffset();
+    for (int i = 0; i < received; ++i) {
+        const QHostAddress sender(ntohl(m_senders[i].sin_addr.s_addr));
+        if (!isAllowed(sender)) {
+            m_rejectedDatagrams++;
+            continue;
+        }
+        m_peerAddress = sender;
+        m_peerPort = ntohs(m_senders[i].sin_port);
+        m_batch[count].data = static_cast<const quint8 *>(m_iovecs[i].iov_base);
+        m_batch[count].size = m_headers[i].msg_len;
+        m_batch[count].rxTimeNs = now;
+
+        struct msghdr &header = m_headers[i].msg_hdr;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg;
+             cmsg = CMSG_NXTHDR(&header, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET &&
+                    cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec stamp;
+                memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                const qint64 systemNs = stamp.tv_sec * Q_INT64_C(1000000000) +
+                        stamp.tv_nsec;
+                m_batch[count].rxTimeNs = systemNs - systemOffset;
+            }
+        }
+        count++;
+    }
+#else
+    const qint64 now = MonotonicClock::now();
+    while (count < BatchSize && m_socket.hasPendingDatagrams()) {
+        char *data = reinterpret_cast<char *>(m_storage.data() + count * MaxDatagramSize);
+        QHostAddress sender;
+        quint16 senderPort = 0;
+        const qint64 size = m_socket.readDatagram(data, MaxDatagramSize,
+                                                  &sender, &senderPort);
+        if (size < 0) {
+            break;
+        }
+        if (!isAllowed(sender)) {
+            m_rejectedDatagrams++;
+            continue;
+        }
+        m_peerAddress = sender;
+        m_peerPort = senderPort;
+        m_batch[count].data = reinterpret_cast<const quint8 *>(data);
+        m_batch[count].size = size;
+        m_batch[count].rxTimeNs = now;
+        count++;
+    }
+#endif
+    return count;
+}
+
+qint64 UdpLink::readData(char * /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+qint64 UdpLink::writeData(const char *data, qint64 maxSize)
+{
+    if (m_peerPort == 0) {
+        // Nobody to talk to yet
+        return -1;
+    }
+#ifdef Q_OS_LINUX
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(m_peerAddress.toIPv4Address());
+    address.sin_port = htons(m_peerPort);
+    const ssize_t size = ::sendto(m_fd, data, maxSize, MSG_DONTWAIT,
+                                  reinterpret_cast<struct sockaddr *>(&address),
+                                  sizeof(address));
+    return size < 0 ? -1 : size;
+#else
+    return m_socket.writeDatagram(data, maxSize, m_peerAddress, m_peerPort);
+#endif
+}
+
+bool UdpLink::isAllowed(const QHostAddress &sender) const
+{
+    if (m_allowedSenders.isEmpty()) {
+        return true;
+    }
+    // Compare IPv4 addresses as numbers, so an IPv4-mapped IPv6 sender of a
+    // dual-stack socket matches its IPv4 form
+    bool senderIsIpv4 = false;
+    const quint32 senderIpv4 = sender.toIPv4Address(&senderIsIpv4);
+    for (const QHostAddress &address : m_allowedSenders) {
+        bool isIpv4 = false;
+        const quint32 ipv4 = address.toIPv4Address(&isIpv4);
+        if ((isIpv4 && senderIsIpv4) ? ipv4 == senderIpv4 : address == sender) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file udp_link.h
+ * @brief File contains a declaration of the MAVLink UDP link - UdpLink
+ */
+
+#ifndef UDP_LINK_H
+#define UDP_LINK_H
+
+#include <QHostAddress>
+#include <QIODevice>
+#include <QList>
+
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#else
+#include <QUdpSocket>
+#endif
+
+/**
+ * @brief UDP endpoint receiving MAVLink datagrams in batches
+ *
+ * Listens on a local port and receives up to BatchSize datagrams per call
+ * of receive() (with a single recvmmsg() on Linux). On Linux every datagram
+ * is stamped with its kernel receive time (SO_TIMESTAMPNS). Datagrams from senders
+ * which are not allowed are dropped. Writes go to the last accepted sender,
+ * so commands reach the autopilot which streams to us.
+ *
+ * Datagrams are read with receive() only, read() is not supported.
+ */
+class UdpLink : public QIODevice
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Received datagram
+     */
+    struct Datagram {
+        const quint8 *data;
+        size_t size;
+        /**
+         * @brief Host monotonic receive time (ns), from the kernel if possible
+         */
+        qint64 rxTimeNs;
+    };
+
+    /**
+     * @brief Maximal number of datagrams returned by one receive()
+     */
+    static const int BatchSize = 16;
+    /**
+     * @brief Maximal size of a datagram, longer ones are truncated
+     */
+    static const int MaxDatagramSize = 2048;
+
+    UdpLink(QObject *parent = Q_NULLPTR);
+    virtual ~UdpLink();
+
+    /**
+     * @brief Set the local port to listen on
+     * @param port UDP port, e.g. 14550
+     */
+    void setPort(quint16 port) { m_port = port; }
+    /**
+     * @brief Get the local port
+     * @return UDP port
+     */
+    quint16 port() const { return m_port; }
+
+    /**
+     * @brief Accept datagrams only from given hosts
+     * @param senders allowed sender addresses, empty to accept everyone
+     */
+    void setAllowedSenders(const QList<QHostAddress> &senders) { m_allowedSenders = senders; }
+    /**
+     * @brief Get the allowed sender addresses
+     * @return Allowed senders, empty if everyone is accepted
+     */
+    QList<QHostAddress> allowedSenders() const { return m_allowedSenders; }
+
+    /**
+     * @brief Bind to the local port
+     * @param mode open mode
+     * @return true on success, false otherwise
+     */
+    bool open(OpenMode mode) Q_DECL_OVERRIDE;
+    /**
+     * @brief Close the socket
+     */
+    void close() Q_DECL_OVERRIDE;
+
+    bool isSequential() const Q_DECL_OVERRIDE { return true; }
+
+    /**
+     * @brief Receive a batch of pending datagrams
+     *
+     * The returned datagrams point into internal storage and stay valid until
+     * the next call.
+     *
+     * @return Number of datagrams available via datagram()
+     */
+    int receive();
+    /**
+     * @brief Get a datagram of the last received batch
+     * @param index datagram index, less than the value returned by receive()
+     * @return Received datagram
+     */
+    const Datagram &datagram(int index) const { return m_batch[index]; }
+
+    /**
+     * @brief Get the number of datagrams dropped by the sender filter
+     * @return Dropped datagrams count
+     */
+    quint64 rejectedDatagrams() const { return m_rejectedDatagrams; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private:
+    /**
+     * @brief Check the datagram sender against m_allowedSenders
+     * @param sender sender address
+     * @return true if datagrams from @p sender are accepted
+     */
+    bool isAllowed(const QHostAddress &sender) const;
+
+private:
+    /**
+     * @brief Local UDP port
+     */
+    quint16 m_port = 14550;
+    /**
+     * @brief Hosts to accept datagrams from, empty to accept all
+     */
+    QList<QHostAddress> m_allowedSenders;
+    /**
+     * @brief Datagrams of the last batch
+     */
+    Datagram m_batch[BatchSize];
+    /**
+     * @brief Storage for a batch of datagrams, allocated once
+     */
+    std::vector<quint8> m_storage;
+    /**
+     * @brief Datagrams dropped by the sender filter
+     */
+    quint64 m_rejectedDatagrams = 0;
+    /**
+     * @brief Address of the last accepted sender
+     */
+    QHostAddress m_peerAddress;
+    /**
+     * @brief Port of the last accepted sender
+     */
+    quint16 m_peerPort = 0;
+
+#ifdef Q_OS_LINUX
+    /**
+     * @brief Socket descriptor, -1 if closed
+     */
+    int m_fd = -1;
+    /**
+     * @brief Read readiness notifier of m_fd
+     */
+    QSocketNotifier *m_notifier = Q_NULLPTR;
+    /**
+     * @brief recvmmsg() headers, set up once
+     */
+    struct mmsghdr m_headers[BatchSize];
+    /**
+     * @brief recvmmsg() buffers, set up once
+     */
+    struct iovec m_iovecs[BatchSize];
+    /**
+     * @brief recvmmsg() sender addresses
+     */
+    struct sockaddr_in m_senders[BatchSize];
+    /**
+     * @brief recvmmsg() control messages carrying receive timestamps
+     */
+    char m_control[BatchSize][CMSG_SPACE(sizeof(struct timespec))];
+#else
+    /**
+     * @brief Socket used where recvmmsg() is not available
+     */
+    QUdpSocket m_socket;
+#endif
+};
+
+#endif // #ifndef UDP_LINK_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "udp_sink.h"
+
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+#ifdef MSG_NOSIGNAL
+const int SendFlags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+// Unconnected datagram sockets don't raise SIGPIPE anyway (e.g. macOS)
+const int SendFlags = MSG_DONTWAIT;
+#endif
+}
+#endif
+
+UdpSink::UdpSink(QObject *parent) :
+    RecordSink(parent)
+#ifndef Q_OS_UNIX
+  , m_socket(this)
+#endif
+{
+}
+
+UdpSink::~UdpSink()
+{
+    close();
+}
+
+bool UdpSink::open()
+{
+    close();
+    bool ok = false;
+    const quint32 address = m_address.toIPv4Address(&ok);
+    if (!ok || m_port == 0) {
+        qWarning().noquote() << tr("Warning: Invalid UDP output destination '%1:%2'.")
+                                .arg(m_address.toString())
+                                .arg(m_port);
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+#ifdef Q_OS_LINUX
+    m_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+    m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd >= 0) {
+        ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+    }
+#endif
+    if (m_fd < 0) {
+        qWarning().noquote() << tr("Warning: Failed to create UDP output socket (%1).")
+                                .arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    if (m_address.isMulticast()) {
+        const int ttl = m_multicastTtl;
+        const unsigned char loop = 1;
+        ::setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        ::setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    }
+
+    memset(&m_destination, 0, sizeof(m_destination));
+    m_destination.sin_family = AF_INET;
+    m_destination.sin_addr.s_addr = htonl(address);
+    m_destination.sin_port = htons(m_port);
+
+    memset(&m_header, 0, sizeof(m_header));
+    m_header.msg_name = &m_destination;
+    m_header.msg_namelen = sizeof(m_destination);
+    m_header.msg_iov = &m_iovec;
+    m_header.msg_iovlen = 1;
+    m_iovec.iov_len = sizeof(AttitudeRecord);
+#else
+    if (!m_socket.bind(QHostAddress::AnyIPv4, 0)) {
+        qWarning().noquote() << tr("Warning: Failed to create UDP output socket (%1).")
+                                .arg(m_socket.errorString());
+        return false;
+    }
+    if (m_address.isMulticast()) {
+        m_socket.setSocketOption(QAbstractSocket::MulticastTtlOption, m_multicastTtl);
+        m_socket.setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+    }
+#endif
+    return true;
+}
+
+void UdpSink::close()
+{
+#ifdef Q_OS_UNIX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#else
+    m_socket.close();
+#endif
+}
+
+bool UdpSink::sendRecord(const AttitudeRecord &record)
+{
+#ifdef Q_OS_UNIX
+    if (m_fd < 0) {
+        return false;
+    }
+    m_iovec.iov_base = const_cast<AttitudeRecord *>(&record);
+    return ::sendmsg(m_fd, &m_header, SendFlags)
+            == static_cast<ssize_t>(sizeof(record));
+#else
+    return m_socket.writeDatagram(reinterpret_cast<const char *>(&record),
+                                  sizeof(record), m_address, m_port)
+            == static_cast<qint64>(sizeof(record));
+#endif
+}
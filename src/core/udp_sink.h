@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file udp_sink.h
+ * @brief File contains a declaration of the binary UDP attitude output - UdpSink
+ */
+
+#ifndef UDP_SINK_H
+#define UDP_SINK_H
+
+#include <QHostAddress>
+
+#ifdef Q_OS_UNIX
+#include <netinet/in.h>
+#include <sys/socket.h>
+#else
+#include <QUdpSocket>
+#endif
+
+#include "record_sink.h"
+
+/**
+ * @brief Attitude output sending binary records as UDP datagrams
+ *
+ * Every sample is sent as one AttitudeRecord datagram with a single
+ * sendmsg() on a prepared message header. The destination may be a
+ * multicast group, so several cameras can listen to one stream; multicast
+ * datagrams are looped back to local listeners.
+ */
+class UdpSink : public RecordSink
+{
+    Q_OBJECT
+public:
+    UdpSink(QObject *parent = Q_NULLPTR);
+    virtual ~UdpSink();
+
+    /**
+     * @brief Set the destination
+     * @param address destination host or multicast group address (IPv4)
+     * @param port destination UDP port
+     */
+    void setDestination(const QHostAddress &address, quint16 port)
+    {
+        m_address = address;
+        m_port = port;
+    }
+    /**
+     * @brief Set the time-to-live of multicast datagrams
+     * @param ttl number of router hops, 1 to stay on the local network
+     */
+    void setMulticastTtl(int ttl) { m_multicastTtl = ttl; }
+
+    /**
+     * @brief Create the socket
+     * @return true on success, false otherwise
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Close the socket
+     */
+    void close() Q_DECL_OVERRIDE;
+
+protected:
+    bool sendRecord(const AttitudeRecord &record) Q_DECL_OVERRIDE;
+
+private:
+    /**
+     * @brief Destination address
+     */
+    QHostAddress m_address;
+    /**
+     * @brief Destination port
+     */
+    quint16 m_port = 0;
+    /**
+     * @brief Time-to-live of multicast datagrams
+     */
+    int m_multicastTtl = 1;
+
+#ifdef Q_OS_UNIX
+    /**
+     * @brief Socket descriptor, -1 if closed
+     */
+    int m_fd = -1;
+    /**
+     * @brief Destination socket address
+     */
+    struct sockaddr_in m_destination;
+    /**
+     * @brief sendmsg() buffer
+     */
+    struct iovec m_iovec;
+    /**
+     * @brief sendmsg() header, set up by open()
+     */
+    struct msghdr m_header;
+#else
+    /**
+     * @brief Socket used where sendmsg() is not available
+     */
+    QUdpSocket m_socket;
+#endif
+};
+
+#endif // #ifndef UDP_SINK_H
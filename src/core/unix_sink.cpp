@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "unix_sink.h"
+
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+#ifdef MSG_NOSIGNAL
+const int SendFlags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+// Unconnected datagram sockets don't raise SIGPIPE anyway (e.g. macOS)
+const int SendFlags = MSG_DONTWAIT;
+#endif
+}
+
+UnixSink::UnixSink(QObject *parent) :
+    RecordSink(parent)
+{
+}
+
+UnixSink::~UnixSink()
+{
+    close();
+}
+
+bool UnixSink::open()
+{
+    close();
+    const QByteArray path = m_path.toLocal8Bit();
+    memset(&m_destination, 0, sizeof(m_destination));
+    m_destination.sun_family = AF_UNIX;
+    if (path.isEmpty() || path.size() >= static_cast<int>(sizeof(m_destination.sun_path))) {
+        qWarning().noquote() << tr("Warning: Invalid Unix socket path '%1'.")
+                                .arg(m_path);
+        return false;
+    }
+    memcpy(m_destination.sun_path, path.constData(), path.size());
+    socklen_t addressSize = offsetof(struct sockaddr_un, sun_path) + path.size() + 1;
+#ifdef Q_OS_LINUX
+    if (path.startsWith('@')) {
+        // Abstract socket: leading zero byte, no terminator
+        m_destination.sun_path[0] = '\0';
+        addressSize--;
+    }
+#endif
+
+#ifdef Q_OS_LINUX
+    m_fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+    m_fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (m_fd >= 0) {
+        ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+    }
+#endif
+    if (m_fd < 0) {
+        qWarning().noquote() << tr("Warning: Failed to create Unix output socket (%1).")
+                                .arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    memset(&m_header, 0, sizeof(m_header));
+    m_header.msg_name = &m_destination;
+    m_header.msg_namelen = addressSize;
+    m_header.msg_iov = &m_iovec;
+    m_header.msg_iovlen = 1;
+    m_iovec.iov_len = sizeof(AttitudeRecord);
+    return true;
+}
+
+void UnixSink::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool UnixSink::sendRecord(const AttitudeRecord &record)
+{
+    if (m_fd < 0) {
+        return false;
+    }
+    m_iovec.iov_base = const_cast<AttitudeRecord *>(&record);
+    return ::sendmsg(m_fd, &m_header, SendFlags)
+            == static_cast<ssize_t>(sizeof(record));
+}
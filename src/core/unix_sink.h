@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file unix_sink.h
+ * @brief File contains a declaration of the Unix datagram attitude output - UnixSink
+ */
+
+#ifndef UNIX_SINK_H
+#define UNIX_SINK_H
+
+#include <QString>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "record_sink.h"
+
+/**
+ * @brief Attitude output sending binary records to a Unix datagram socket
+ *
+ * Every sample is sent as one AttitudeRecord datagram with a single
+ * sendmsg() to the socket a local consumer has bound. Records are dropped
+ * while nobody listens or the consumer's queue is full. A path starting
+ * with '@' names a Linux abstract socket.
+ */
+class UnixSink : public RecordSink
+{
+    Q_OBJECT
+public:
+    UnixSink(QObject *parent = Q_NULLPTR);
+    virtual ~UnixSink();
+
+    /**
+     * @brief Set the consumer socket path
+     * @param path socket path, e.g. "/run/attfeeder/attitude.sock"
+     */
+    void setPath(const QString &path) { m_path = path; }
+    /**
+     * @brief Get the consumer socket path
+     * @return Socket path
+     */
+    QString path() const { return m_path; }
+
+    /**
+     * @brief Create the socket
+     * @return true on success, false otherwise
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Close the socket
+     */
+    void close() Q_DECL_OVERRIDE;
+
+protected:
+    bool sendRecord(const AttitudeRecord &record) Q_DECL_OVERRIDE;
+
+private:
+    /**
+     * @brief Consumer socket path
+     */
+    QString m_path;
+    /**
+     * @brief Socket descriptor, -1 if closed
+     */
+    int m_fd = -1;
+    /**
+     * @brief Consumer socket address
+     */
+    struct sockaddr_un m_destination;
+    /**
+     * @brief sendmsg() buffer
+     */
+    struct iovec m_iovec;
+    /**
+     * @brief sendmsg() header, set up by open()
+     */
+    struct msghdr m_header;
+};
+
+#endif // #ifndef UNIX_SINK_H
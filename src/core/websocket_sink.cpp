@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "websocket_sink.h"
+
+#include <QNetworkProxy>
+
+#include <QDebug>
+
+WebSocketSink::WebSocketSink(QObject *parent) :
+    AttitudeSink(parent), m_socket(QString(), QWebSocketProtocol::VersionLatest, this),
+    m_reconnectTimer(this)
+{
+    m_socket.setProxy(QNetworkProxy::NoProxy);
+    m_reconnectTimer.setSingleShot(true);
+    m_reconnectTimer.setInterval(ReconnectInterval);
+
+    connect(&m_socket, &QWebSocket::connected,
+            this, &WebSocketSink::handleConnected);
+    connect(&m_socket, &QWebSocket::disconnected,
+            this, &WebSocketSink::handleDisconnected);
+    connect(&m_socket, &QWebSocket::bytesWritten,
+            this, &WebSocketSink::handleBytesWritten);
+    connect(&m_reconnectTimer, &QTimer::timeout,
+            this, &WebSocketSink::connectToServer);
+}
+
+WebSocketSink::~WebSocketSink()
+{
+    close();
+}
+
+bool WebSocketSink::open()
+{
+    if (m_url.scheme() != QLatin1String("ws") && m_url.scheme() != QLatin1String("wss")) {
+        qWarning().noquote() << tr("Warning: Unsupported WebSocket URL '%1'.")
+                                .arg(m_url.toString());
+        return false;
+    }
+    m_open = true;
+    connectToServer();
+    return true;
+}
+
+void WebSocketSink::close()
+{
+    m_open = false;
+    m_connected = false;
+    m_backlog = 0;
+    m_reconnectTimer.stop();
+    m_socket.abort();
+}
+
+void WebSocketSink::write(const AttitudeSample &sample)
+{
+    m_latest = sample;
+    m_latestSeq++;
+    if (m_socket.state() != QAbstractSocket::ConnectedState
+            || isBusy()
+            || !sendLatest()) {
+        m_droppedSamples++;
+    }
+}
+
+bool WebSocketSink::sendLatest()
+{
+    const char *out = AttitudeJson::append(m_frame, m_latest, m_latestSeq);
+    const int size = static_cast<int>(out - m_frame);
+    const qint64 sent = m_socket.sendTextMessage(QString::fromLatin1(m_frame, size));
+    m_backlog += sent;
+    return sent == size;
+}
+
+void WebSocketSink::connectToServer()
+{
+    if (!m_open || m_socket.state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    m_socket.open(m_url);
+}
+
+void WebSocketSink::handleConnected()
+{
+    m_connected = true;
+    qInfo().noquote() << tr("WebSocket output connected to '%1'.")
+                         .arg(m_url.toString());
+    if (m_latestSeq > 0) {
+        sendLatest();
+    }
+}
+
+void WebSocketSink::handleDisconnected()
+{
+    if (m_open && m_connected) {
+        qWarning().noquote() << tr("Warning: WebSocket connection to '%1' lost, "
+                                   "reconnecting.")
+                                .arg(m_url.toString());
+    }
+    m_connected = false;
+    m_backlog = 0;
+    if (m_open && !m_reconnectTimer.isActive()) {
+        m_reconnectTimer.start();
+    }
+}
+
+void WebSocketSink::handleBytesWritten(qint64 bytes)
+{
+    m_backlog = qMax(Q_INT64_C(0), m_backlog - bytes);
+    if (!isBusy()) {
+        emit ready();
+    }
+}
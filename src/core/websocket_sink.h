@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file websocket_sink.h
+ * @brief File contains a declaration of the WebSocket attitude output - WebSocketSink
+ */
+
+#ifndef WEBSOCKET_SINK_H
+#define WEBSOCKET_SINK_H
+
+#include <QTimer>
+#include <QUrl>
+#include <QWebSocket>
+
+#include "attitude_json.h"
+#include "attitude_sink.h"
+
+/**
+ * @brief Attitude output streaming samples over one WebSocket connection
+ *
+ * Every sample is sent as a compact JSON text frame (see AttitudeJson).
+ *
+ * A lost connection is re-established after ReconnectInterval and the latest
+ * sample is sent again as soon as it is up. Samples are dropped while
+ * disconnected or while more than MaxBacklog bytes wait to be sent.
+ */
+class WebSocketSink : public AttitudeSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Delay before reconnecting after a connection loss (ms)
+     */
+    static const int ReconnectInterval = 1000;
+    /**
+     * @brief Maximal number of unsent bytes before samples are dropped
+     */
+    static const qint64 MaxBacklog = 4096;
+
+    WebSocketSink(QObject *parent = Q_NULLPTR);
+    virtual ~WebSocketSink();
+
+    /**
+     * @brief Set the server URL
+     * @param url WebSocket URL, e.g. "ws://127.0.0.1:8124/attitude"
+     */
+    void setUrl(const QUrl &url) { m_url = url; }
+    /**
+     * @brief Get the server URL
+     * @return WebSocket URL
+     */
+    QUrl url() const { return m_url; }
+
+    /**
+     * @brief Connect to the server
+     * @return true on success, false if the URL is not supported
+     */
+    bool open() Q_DECL_OVERRIDE;
+    /**
+     * @brief Disconnect from the server
+     */
+    void close() Q_DECL_OVERRIDE;
+    /**
+     * @brief Send an attitude sample
+     * @param sample attitude sample with angles in radians
+     */
+    void write(const AttitudeSample &sample) Q_DECL_OVERRIDE;
+    /**
+     * @brief Check if too much data waits to be sent
+     * @return true if more than MaxBacklog bytes are not sent yet
+     */
+    bool isBusy() const Q_DECL_OVERRIDE { return m_backlog > MaxBacklog; }
+
+    /**
+     * @brief Get the number of samples which were not sent
+     * @return Dropped samples count
+     */
+    quint64 droppedSamples() const Q_DECL_OVERRIDE { return m_droppedSamples; }
+
+private slots:
+    /**
+     * @brief Connect to the server
+     */
+    void connectToServer();
+    /**
+     * @brief Send the latest sample again after (re)connecting
+     */
+    void handleConnected();
+    /**
+     * @brief Schedule a reconnect after the connection is closed
+     */
+    void handleDisconnected();
+    /**
+     * @brief Account for sent bytes and report readiness once the backlog is sent
+     * @param bytes number of bytes written to the connection
+     */
+    void handleBytesWritten(qint64 bytes);
+
+private:
+    /**
+     * @brief Format and send the latest sample
+     * @return true if the frame was queued for sending
+     */
+    bool sendLatest();
+
+private:
+    /**
+     * @brief WebSocket URL
+     */
+    QUrl m_url;
+    /**
+     * @brief Persistent connection to the server
+     */
+    QWebSocket m_socket;
+    /**
+     * @brief Timer restoring a lost connection
+     */
+    QTimer m_reconnectTimer;
+    /**
+     * @brief Whether the sink is open
+     */
+    bool m_open = false;
+    /**
+     * @brief Whether the connection has been established
+     */
+    bool m_connected = false;
+    /**
+     * @brief Bytes queued for sending and not written yet
+     *
+     * Kept here since QWebSocket::bytesToWrite() needs Qt 5.12. Written bytes
+     * include frame headers, so the count errs towards an empty backlog.
+     */
+    qint64 m_backlog = 0;
+
+    /**
+     * @brief Latest sample
+     */
+    AttitudeSample m_latest;
+    /**
+     * @brief Sequence number of m_latest, 0 if there was no sample yet
+     */
+    quint64 m_latestSeq = 0;
+    /**
+     * @brief Samples which were not sent
+     */
+    quint64 m_droppedSamples = 0;
+
+    /**
+     * @brief Frame buffer, big enough for any frame
+     */
+    char m_frame[AttitudeJson::MaxLength];
+};
+
+#endif // #ifndef WEBSOCKET_SINK_H
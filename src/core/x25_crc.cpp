@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "x25_crc.h"
+
+namespace {
+
+/**
+ * @brief Lookup tables for slice-by-8 processing
+ *
+ * table[0] is the classic byte-wise table, table[k] gives the contribution
+ * of a byte followed by k more bytes.
+ */
+struct Tables
+{
+    Tables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            quint16 crc = 0;
+            crc_accumulate(static_cast<quint8>(i), &crc);
+            table[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                const quint16 prev = table[k - 1][i];
+                table[k][i] = (prev >> 8) ^ table[0][prev & 0xff];
+            }
+        }
+    }
+
+    quint16 table[8][256];
+};
+
+const Tables &tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+} // namespace
+
+quint16 X25Crc::accumulate(quint16 crc, const quint8 *data, size_t length)
+{
+    const quint16 (&t)[8][256] = tables().table;
+
+    while (length >= 8) {
+        crc = t[7][(data[0] ^ crc) & 0xff] ^
+              t[6][data[1] ^ (crc >> 8)] ^
+              t[5][data[2]] ^
+              t[4][data[3]] ^
+              t[3][data[4]] ^
+              t[2][data[5]] ^
+              t[1][data[6]] ^
+              t[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ t[0][(*data++ ^ crc) & 0xff];
+    }
+    return crc;
+}
+
+quint16 X25Crc::accumulate(quint16 crc, quint8 data)
+{
+    return (crc >> 8) ^ tables().table[0][(data ^ crc) & 0xff];
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+/**
+ * @file x25_crc.h
+ * @brief File contains a buffer-oriented X.25 CRC used to validate MAVLink frames
+ */
+
+#ifndef X25_CRC_H
+#define X25_CRC_H
+
+#include <QtGlobal>
+
+#include <checksum.h>
+
+/**
+ * @brief Table-driven (slice-by-8) implementation of the MAVLink X.25 CRC
+ *
+ * Results are bit-for-bit identical to crc_accumulate() from checksum.h, but
+ * eight bytes are folded into the checksum per iteration instead of one.
+ */
+namespace X25Crc {
+
+/**
+ * @brief Accumulate the X.25 CRC over a byte buffer
+ * @param crc the already accumulated checksum
+ * @param data bytes to hash
+ * @param length number of bytes to hash
+ * @return the updated checksum
+ */
+quint16 accumulate(quint16 crc, const quint8 *data, size_t length);
+
+/**
+ * @brief Accumulate the X.25 CRC over a single byte
+ * @param crc the already accumulated checksum
+ * @param data byte to hash
+ * @return the updated checksum
+ */
+quint16 accumulate(quint16 crc, quint8 data);
+
+/**
+ * @brief Calculate the X.25 CRC of a byte buffer
+ * @param data bytes to hash
+ * @param length number of bytes to hash
+ * @return the checksum over the buffer bytes
+ */
+inline quint16 calculate(const quint8 *data, size_t length)
+{
+    return accumulate(X25_INIT_CRC, data, length);
+}
+
+} // namespace X25Crc
+
+#endif // #ifndef X25_CRC_H
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+
+/**
+ * @file attitude_kernels_test.cpp
+ * @brief Accuracy test of the batch attitude conversions - AttitudeKernels
+ *
+ * Conversions of random attitudes, including pitch within the gimbal lock
+ * margin, are compared with the scalar mavlink_conversions.h functions and
+ * with double precision. Returns non-zero if an error exceeds its limit.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "attitude_kernels.h"
+
+// mavlink_conversions.h leaves the linkage of its helpers to protocol.h
+#define MAVLINK_HELPER static inline
+#include <mavlink_conversions.h>
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+/**
+ * @brief Pitch margin around +-pi/2 handled as the gimbal lock
+ */
+const double LockMargin = 1e-3;
+/**
+ * @brief Number of samples per check
+ */
+const int SampleCount = 1 << 20;
+
+/**
+ * @brief Float ulp at 1
+ *
+ * Limits are twice the worst error seen with and without FMA contraction,
+ * in ulps where the error comes from float rounding.
+ */
+const double Ulp = FLT_EPSILON;
+/**
+ * @brief Maximal quaternion component difference from mavlink_euler_to_quaternion()
+ */
+const double EulerToQuaternionLimit = 4 * Ulp;
+/**
+ * @brief Maximal element difference from mavlink_quaternion_to_dcm()
+ */
+const double QuaternionToDcmLimit = 2 * Ulp;
+/**
+ * @brief Maximal pitch error (rad)
+ */
+const double PitchLimit = 4 * Ulp;
+/**
+ * @brief Maximal roll and yaw error away from the gimbal lock (rad)
+ */
+const double AngleLimit = 1.5e-5;
+/**
+ * @brief Maximal rotation error (rad)
+ *
+ * Reached within the lock margin, where roll is folded into yaw and the
+ * rotation is off by up to 2 * LockMargin.
+ */
+const double RotationLimit = 3 * LockMargin;
+/**
+ * @brief Maximal rotation error right at pitch +-pi/2 (rad)
+ */
+const double LockRotationLimit = 1e-6;
+
+struct Euler
+{
+    double roll;
+    double pitch;
+    double yaw;
+};
+
+struct Quaternion
+{
+    double w;
+    double x;
+    double y;
+    double z;
+};
+
+Quaternion toQuaternion(double roll, double pitch, double yaw)
+{
+    const double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+    const double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+    const double cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+    Quaternion q;
+    q.w = cr * cp * cy + sr * sp * sy;
+    q.x = sr * cp * cy - cr * sp * sy;
+    q.y = cr * sp * cy + sr * cp * sy;
+    q.z = cr * cp * sy - sr * sp * cy;
+    return q;
+}
+
+/**
+ * @brief Pitch of a float quaternion in double precision
+ *
+ * Rounding the input to float alone moves pitch by up to about 1e-7, so the
+ * kernel pitch is compared with the pitch of the quaternion it was given.
+ */
+double exactPitch(double w, double x, double y, double z)
+{
+    const double dcm00 = w * w + x * x - y * y - z * z;
+    const double dcm10 = 2 * (x * y + w * z);
+    const double dcm20 = 2 * (x * z - w * y);
+    return std::atan2(-dcm20, std::sqrt(dcm00 * dcm00 + dcm10 * dcm10));
+}
+
+/**
+ * @brief Angle of the rotation between two unit quaternions
+ */
+double rotationError(const Quaternion &a, const Quaternion &b)
+{
+    const double dot = std::fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+    return 2 * std::acos(std::min(1.0, dot));
+}
+
+/**
+ * @brief Difference of two angles, wrapped to [0, pi]
+ */
+double angleError(double a, double b)
+{
+    return std::fabs(std::remainder(a - b, 2 * Pi));
+}
+
+/**
+ * @brief Random attitudes
+ *
+ * Every fourth pitch is within LockMargin of +-pi/2, every 64th is exactly
+ * +-pi/2, the rest is uniform over the sphere.
+ */
+std::vector<Euler> randomAngles(std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> angle(-Pi, Pi);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> margin(0, LockMargin);
+    std::vector<Euler> angles(SampleCount);
+    for (int i = 0; i < SampleCount; i++) {
+        Euler &e = angles[i];
+        e.roll = angle(random);
+        e.yaw = angle(random);
+        const double sign = (i / 4) % 2 ? 1 : -1;
+        if (i % 64 == 0) {
+            e.pitch = sign * Pi / 2;
+        } else if (i % 4 == 0) {
+            e.pitch = sign * (Pi / 2 - margin(random));
+        } else {
+            e.pitch = std::asin(unit(random));
+        }
+    }
+    return angles;
+}
+
+bool check(const char *name, double error, double limit)
+{
+    const bool ok = error <= limit;
+    std::printf("%s %-40s %.3g (limit %.3g)\n", ok ? "PASS" : "FAIL", name, error, limit);
+    return ok;
+}
+
+bool testEulerToQuaternion(std::mt19937 &random)
+{
+    const std::vector<Euler> angles = randomAngles(random);
+    std::vector<float> roll(SampleCount), pitch(SampleCount), yaw(SampleCount);
+    std::vector<float> w(SampleCount), x(SampleCount), y(SampleCount), z(SampleCount);
+    for (int i = 0; i < SampleCount; i++) {
+        roll[i] = static_cast<float>(angles[i].roll);
+        pitch[i] = static_cast<float>(angles[i].pitch);
+        yaw[i] = static_cast<float>(angles[i].yaw);
+    }
+    AttitudeKernels::eulerToQuaternion(roll.data(), pitch.data(), yaw.data(),
+                                       w.data(), x.data(), y.data(), z.data(), SampleCount);
+
+    double error = 0;
+    for (int i = 0; i < SampleCount; i++) {
+        float q[4];
+        mavlink_euler_to_quaternion(roll[i], pitch[i], yaw[i], q);
+        error = std::max(error, static_cast<double>(std::fabs(w[i] - q[0])));
+        error = std::max(error, static_cast<double>(std::fabs(x[i] - q[1])));
+        error = std::max(error, static_cast<double>(std::fabs(y[i] - q[2])));
+        error = std::max(error, static_cast<double>(std::fabs(z[i] - q[3])));
+    }
+    return check("euler to quaternion", error, EulerToQuaternionLimit);
+}
+
+bool testQuaternionToDcm(std::mt19937 &random)
+{
+    std::normal_distribution<float> normal;
+    std::vector<float> w(SampleCount), x(SampleCount), y(SampleCount), z(SampleCount);
+    for (int i = 0; i < SampleCount; i++) {
+        const float a = normal(random), b = normal(random), c = normal(random), d = normal(random);
+        const float norm = std::sqrt(a * a + b * b + c * c + d * d);
+        w[i] = a / norm;
+        x[i] = b / norm;
+        y[i] = c / norm;
+        z[i] = d / norm;
+    }
+    std::vector<float> elements[3][3];
+    float *dcm[3][3];
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            elements[r][c].resize(SampleCount);
+            dcm[r][c] = elements[r][c].data();
+        }
+    }
+    AttitudeKernels::quaternionToDcm(w.data(), x.data(), y.data(), z.data(), dcm, SampleCount);
+
+    double error = 0;
+    for (int i = 0; i < SampleCount; i++) {
+        const float q[4] = {w[i], x[i], y[i], z[i]};
+        float expected[3][3];
+        mavlink_quaternion_to_dcm(q, expected);
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                error = std::max(error, static_cast<double>(std::fabs(dcm[r][c][i] - expected[r][c])));
+            }
+        }
+    }
+    return check("quaternion to DCM", error, QuaternionToDcmLimit);
+}
+
+bool testQuaternionToEuler(std::mt19937 &random)
+{
+    const std::vector<Euler> angles = randomAngles(random);
+    std::vector<float> w(SampleCount), x(SampleCount), y(SampleCount), z(SampleCount);
+    std::vector<float> roll(SampleCount), pitch(SampleCount), yaw(SampleCount);
+    for (int i = 0; i < SampleCount; i++) {
+        const Quaternion q = toQuaternion(angles[i].roll, angles[i].pitch, angles[i].yaw);
+        w[i] = static_cast<float>(q.w);
+        x[i] = static_cast<float>(q.x);
+        y[i] = static_cast<float>(q.y);
+        z[i] = static_cast<float>(q.z);
+    }
+    AttitudeKernels::quaternionToEuler(w.data(), x.data(), y.data(), z.data(),
+                                       roll.data(), pitch.data(), yaw.data(), SampleCount);
+
+    double pitchError = 0, angleErrorAway = 0, rotation = 0, lockRotation = 0;
+    for (int i = 0; i < SampleCount; i++) {
+        const Euler &e = angles[i];
+        const double error = rotationError(toQuaternion(e.roll, e.pitch, e.yaw),
+                                           toQuaternion(roll[i], pitch[i], yaw[i]));
+        rotation = std::max(rotation, error);
+        if (std::fabs(e.pitch) == Pi / 2) {
+            lockRotation = std::max(lockRotation, error);
+        }
+        pitchError = std::max(pitchError, std::fabs(pitch[i] - exactPitch(w[i], x[i], y[i], z[i])));
+        if (std::fabs(e.pitch) < Pi / 2 - 10 * LockMargin) {
+            angleErrorAway = std::max(angleErrorAway, angleError(roll[i], e.roll));
+            angleErrorAway = std::max(angleErrorAway, angleError(yaw[i], e.yaw));
+        }
+    }
+    bool ok = check("quaternion to euler: pitch", pitchError, PitchLimit);
+    ok = check("quaternion to euler: roll, yaw", angleErrorAway, AngleLimit) && ok;
+    ok = check("quaternion to euler: rotation", rotation, RotationLimit) && ok;
+    ok = check("quaternion to euler: rotation at lock", lockRotation, LockRotationLimit) && ok;
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(2017);
+    bool ok = testEulerToQuaternion(random);
+    ok = testQuaternionToDcm(random) && ok;
+    ok = testQuaternionToEuler(random) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017, Smart Projects Holdings Ltd
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Smart Projects Holdings Ltd nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SMART PROJECTS HOLDINGS LTD BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+
+/**
+ * @file x25_crc_test.cpp
+ * @brief Test of the slice-by-8 X.25 CRC - X25Crc
+ *
+ * X25Crc results are compared bit for bit with crc_calculate() and
+ * crc_accumulate() from checksum.h on random buffers of every MAVLink frame
+ * length at every alignment. Returns non-zero on a mismatch.
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "x25_crc.h"
+
+namespace {
+
+/**
+ * @brief Longest buffer checked, a full MAVLink 1 frame
+ */
+const int MaxLength = 263;
+/**
+ * @brief Number of start offsets checked, covering every alignment of a word
+ */
+const int Offsets = 8;
+/**
+ * @brief Number of random buffers per length and offset
+ */
+const int Rounds = 16;
+
+quint16 referenceAccumulate(quint16 crc, const quint8 *data, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        crc_accumulate(data[i], &crc);
+    }
+    return crc;
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(2017);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> word(0, 0xffff);
+    std::vector<quint8> buffer(MaxLength + Offsets);
+
+    int failures = 0;
+    for (int round = 0; round < Rounds; ++round) {
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            buffer[i] = static_cast<quint8>(byte(random));
+        }
+        for (int offset = 0; offset < Offsets; ++offset) {
+            const quint8 *data = buffer.data() + offset;
+            for (int length = 0; length <= MaxLength; ++length) {
+                const quint16 expected = crc_calculate(data, static_cast<quint16>(length));
+                const quint16 calculated = X25Crc::calculate(data, length);
+
+                const quint16 start = static_cast<quint16>(word(random));
+                const quint16 expectedAccumulated = referenceAccumulate(start, data, length);
+                // Split somewhere, as frames are hashed in parts
+                const int split = length / 3;
+                const quint16 accumulated = X25Crc::accumulate(
+                            X25Crc::accumulate(start, data, split), data + split, length - split);
+
+                quint16 single = start;
+                for (int i = 0; i < length; ++i) {
+                    single = X25Crc::accumulate(single, data[i]);
+                }
+
+                if (calculated != expected || accumulated != expectedAccumulated
+                        || single != expectedAccumulated) {
+                    if (failures++ < 10) {
+                        std::printf("FAIL length %d offset %d: calculate %04x/%04x, "
+                                    "accumulate %04x/%04x, byte-wise %04x/%04x\n",
+                                    length, offset, calculated, expected,
+                                    accumulated, expectedAccumulated,
+                                    single, expectedAccumulated);
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures > 0) {
+        std::printf("FAIL %d mismatches\n", failures);
+        return 1;
+    }
+    std::printf("PASS X.25 CRC, lengths 0 to %d at %d offsets\n", MaxLength, Offsets);
+    return 0;
+}